@@ -24,6 +24,19 @@
 #include "Platform/OpenGL/OpenGLShader.h"
 #include "Hazel/Core/Core.h"
 #include <Renderer/Texture.h>
+#include <Renderer/TextureAtlas.h>
+#include <Renderer/TextureArrayPool.h>
+#include <Renderer/RenderCaps.h>
+#include <Renderer/RenderQueue.h>
+#include <Renderer/SpatialHashGrid.h>
+#include <Renderer/SubTexture2D.h>
+#include <Renderer/Font.h>
+#include <Renderer/Tilemap.h>
+#include <Renderer/ParticleSystem.h>
+#include <Renderer/Triangulator.h>
+#include <Renderer/LightGrid.h>
+#include <Renderer/OcclusionBuffer.h>
+#include <Renderer/SpriteCuller.h>
 #include "OrthographicCameraController.h"
 
 // -----Entry Point-------
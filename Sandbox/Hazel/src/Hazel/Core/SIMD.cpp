@@ -0,0 +1,54 @@
+#include "SIMD.h"
+
+#if HZ_SIMD_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace Hazel {
+
+    static SIMD::Level DetectSIMDLevel() {
+#if HZ_SIMD_X86
+    #if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+
+        // SSE2是x86-64的基线，这里只需要确认AVX2以及操作系统是否保存了YMM寄存器
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || maxLeaf < 7) {
+            return SIMD::Level::SSE;
+        }
+        if ((_xgetbv(0) & 0x6) != 0x6) {
+            return SIMD::Level::SSE;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) ? SIMD::Level::AVX2 : SIMD::Level::SSE;
+    #else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SIMD::Level::AVX2;
+        }
+        return __builtin_cpu_supports("sse2") ? SIMD::Level::SSE : SIMD::Level::Scalar;
+    #endif
+#else
+        return SIMD::Level::Scalar;
+#endif
+    }
+
+    SIMD::Level SIMD::GetSupportedLevel() {
+        static Level s_Level = DetectSIMDLevel();
+        return s_Level;
+    }
+
+    const char* SIMD::GetLevelName(Level level) {
+        switch (level) {
+            case Level::Scalar: return "Scalar";
+            case Level::SSE:    return "SSE";
+            case Level::AVX2:   return "AVX2";
+        }
+        return "Unknown";
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+    #define HZ_SIMD_X86 1
+#else
+    #define HZ_SIMD_X86 0
+#endif
+
+// GCC/Clang需要用target属性单独开启AVX2，MSVC可以直接使用intrinsics
+#if HZ_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+    #define HZ_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+    #define HZ_TARGET_AVX2
+#endif
+
+namespace Hazel {
+    // 运行时检测CPU支持的SIMD指令集，x86以外的平台（比如Apple Silicon）只走标量实现
+    class SIMD {
+    public:
+        enum class Level {
+            Scalar = 0, SSE = 1, AVX2 = 2
+        };
+
+        // CPU实际支持的最高级别，只检测一次
+        static Level GetSupportedLevel();
+
+        static const char* GetLevelName(Level level);
+    };
+}
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <fstream>
+#include <mutex>
 #include <thread>
 #include <algorithm>
 
@@ -24,6 +25,8 @@ private:
     InstrumentationSession* m_CurrentSession;
     std::ofstream m_OutputStream;
     int m_ProfileCount;
+    // Renderer2D的多线程提交会在工作线程上记录，写文件要串行
+    std::mutex m_Lock;
 public:
     Instrumentor() : m_CurrentSession(nullptr), m_ProfileCount(0)
     {
@@ -60,6 +63,7 @@ public:
 
     void WriteProfile(const ProfileResult& result)
     {
+        std::lock_guard<std::mutex> lock(m_Lock);
         if (m_ProfileCount++ > 0) {
             m_OutputStream << ",";
         }
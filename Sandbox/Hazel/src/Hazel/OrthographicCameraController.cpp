@@ -37,6 +37,11 @@ namespace Hazel {
         m_CameraMoveSpeed = m_ZoomLevel;
     }
 
+    void OrthographicCameraController::SetZoomLevel(float level) {
+        m_ZoomLevel = level;
+        m_Camera.SetProjection(-m_AspectRatio * m_ZoomLevel, m_AspectRatio * m_ZoomLevel, -m_ZoomLevel, m_ZoomLevel);
+    }
+
     // 在OnEvent中分发MouseScrolledEvent和WindowResizeEvent事件
     void OrthographicCameraController::OnEvent(Event &e) {
         HZ_PROFILE_FUNCTION();
@@ -15,6 +15,9 @@ namespace Hazel {
         OrthographicCamera& GetCamera(){return m_Camera;}
         const OrthographicCamera& GetCamera() const {return m_Camera;}
 
+        float GetZoomLevel() const {return m_ZoomLevel;}
+        void SetZoomLevel(float level);
+
     private:
         bool OnMouseScrolled(MouseScrolledEvent& e);
         bool OnWindowsResized(WindowResizeEvent& e);
@@ -4,9 +4,22 @@
 
 #include "OpenGLBuffer.h"
 
+#include <chrono>
+
 #include <glad/glad.h>
+#include <GLFW/glfw3.h>
 
+#include "Base.h"
 #include "Debugger/Instrumentor.h"
+#include "Renderer/RenderCaps.h"
+
+// glad只生成了3.3 core，GL_ARB_buffer_storage(4.4)的函数和常量需要自己补上
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
 
 namespace Hazel {
 
@@ -54,6 +67,218 @@ namespace Hazel {
         glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
     }
 
+    void OpenGLVertexBuffer::SetSubData(const void *data, uint32_t size, uint32_t offset) {
+        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // StreamingVertexBuffer ////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    typedef void (APIENTRYP BufferStorageFn)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+    static BufferStorageFn LoadBufferStorage() {
+        return RenderCaps::Get().BufferStorage ? (BufferStorageFn)glfwGetProcAddress("glBufferStorage") : nullptr;
+    }
+
+    OpenGLStreamingVertexBuffer::OpenGLStreamingVertexBuffer(uint32_t regionSize, uint32_t regionCount)
+        : m_RegionSize(regionSize), m_RegionCount(regionCount), m_Fences(regionCount, nullptr) {
+        HZ_PROFILE_FUNCTION();
+
+        HZ_CORE_ASSERT(regionCount > 0, "Streaming buffer needs at least one region");
+
+        static BufferStorageFn s_BufferStorage = LoadBufferStorage();
+
+        glGenBuffers(1, &m_RendererID);
+        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+
+        GLsizeiptr size = (GLsizeiptr)m_RegionSize * m_RegionCount;
+        if (s_BufferStorage) {
+            // 持久+一致映射：整个生命周期只映射一次，写入对GPU直接可见
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            s_BufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+            m_PersistentPtr = (uint8_t*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+            if (!m_PersistentPtr) {
+                // glBufferStorage分配的存储不可变，不能再glBufferData，换一个新的缓冲
+                glDeleteBuffers(1, &m_RendererID);
+                glGenBuffers(1, &m_RendererID);
+                glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+            }
+        }
+        if (!m_PersistentPtr) {
+            glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        }
+
+        HZ_CORE_INFO("Streaming vertex buffer: {0} x {1} bytes, {2}", m_RegionCount, m_RegionSize,
+                     m_PersistentPtr ? "persistent mapping" : "unsynchronized mapping");
+    }
+
+    OpenGLStreamingVertexBuffer::~OpenGLStreamingVertexBuffer() {
+        HZ_PROFILE_FUNCTION();
+
+        for (void* fence : m_Fences) {
+            if (fence) {
+                glDeleteSync((GLsync)fence);
+            }
+        }
+        if (m_PersistentPtr || m_Mapped) {
+            glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        glDeleteBuffers(1, &m_RendererID);
+    }
+
+    void OpenGLStreamingVertexBuffer::Bind() const {
+        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    }
+
+    void OpenGLStreamingVertexBuffer::Unbind() const {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void OpenGLStreamingVertexBuffer::SetData(const void *data, uint32_t size) {
+        HZ_CORE_ASSERT(size <= m_RegionSize, "Data larger than a streaming region");
+
+        // 和Map/Unmap的用法一样，只是不返回偏移，调用方用GetRegionOffset()；Fence要等绘制提交之后由调用方插入
+        memcpy(Map(), data, size);
+        Unmap(size);
+    }
+
+    void OpenGLStreamingVertexBuffer::SetSubData(const void *data, uint32_t size, uint32_t offset) {
+        HZ_CORE_ASSERT(false, "StreamingVertexBuffer does not support partial updates");
+    }
+
+    void OpenGLStreamingVertexBuffer::WaitForRegion(uint32_t region) {
+        GLsync fence = (GLsync)m_Fences[region];
+        if (!fence) {
+            return;
+        }
+
+        // 先不阻塞地查询一次，大多数情况下GPU早就读完了
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED) {
+            m_Stats.FenceWaits++;
+            auto start = std::chrono::high_resolution_clock::now();
+            do {
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1ms
+            } while (result == GL_TIMEOUT_EXPIRED);
+            auto end = std::chrono::high_resolution_clock::now();
+            m_Stats.StallTime += std::chrono::duration<float, std::milli>(end - start).count();
+        }
+
+        glDeleteSync(fence);
+        m_Fences[region] = nullptr;
+    }
+
+    void OpenGLStreamingVertexBuffer::Orphan() {
+        // 分配一块新的存储，旧的交给驱动在GPU用完后回收，之前的fence都不再需要
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_RegionSize * m_RegionCount, nullptr, GL_STREAM_DRAW);
+        for (auto& fence : m_Fences) {
+            if (fence) {
+                glDeleteSync((GLsync)fence);
+                fence = nullptr;
+            }
+        }
+        m_Stats.Orphans++;
+    }
+
+    void* OpenGLStreamingVertexBuffer::Map() {
+        HZ_PROFILE_FUNCTION();
+
+        HZ_CORE_ASSERT(!m_Mapped, "Streaming buffer region already mapped");
+        m_Mapped = true;
+
+        if (m_PersistentPtr) {
+            WaitForRegion(m_CurrentRegion);
+            return m_PersistentPtr + (size_t)m_CurrentRegion * m_RegionSize;
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+
+        // 非持久映射时不等待，区域还在被GPU读取就直接orphan
+        GLsync fence = (GLsync)m_Fences[m_CurrentRegion];
+        if (fence) {
+            if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+                Orphan();
+            } else {
+                glDeleteSync(fence);
+                m_Fences[m_CurrentRegion] = nullptr;
+            }
+        }
+
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+        return glMapBufferRange(GL_ARRAY_BUFFER, (GLintptr)m_CurrentRegion * m_RegionSize, m_RegionSize, access);
+    }
+
+    uint32_t OpenGLStreamingVertexBuffer::Unmap(uint32_t usedSize) {
+        HZ_PROFILE_FUNCTION();
+
+        HZ_CORE_ASSERT(m_Mapped, "Streaming buffer region is not mapped");
+        m_Mapped = false;
+
+        if (!m_PersistentPtr) {
+            glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+            // 只刷新实际写入的部分
+            if (usedSize) {
+                glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, usedSize);
+            }
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        return GetRegionOffset();
+    }
+
+    void OpenGLStreamingVertexBuffer::Fence() {
+        HZ_CORE_ASSERT(!m_Fences[m_CurrentRegion], "Region already fenced");
+
+        m_Fences[m_CurrentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_CurrentRegion = (m_CurrentRegion + 1) % m_RegionCount;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // TextureBuffer ////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    OpenGLTextureBuffer::OpenGLTextureBuffer(uint32_t size, TextureBufferFormat format) : m_Size(size) {
+        HZ_PROFILE_FUNCTION();
+
+        const uint32_t texelSize = format == TextureBufferFormat::R32UI ? 4 : 16;
+        HZ_CORE_ASSERT(size % texelSize == 0, "TextureBuffer size must be a multiple of the texel size!");
+        HZ_CORE_ASSERT(size / texelSize <= RenderCaps::Get().MaxTextureBufferSize, "TextureBuffer larger than GL_MAX_TEXTURE_BUFFER_SIZE!");
+
+        glGenBuffers(1, &m_BufferID);
+        glBindBuffer(GL_TEXTURE_BUFFER, m_BufferID);
+        glBufferData(GL_TEXTURE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+        glGenTextures(1, &m_TextureID);
+        glBindTexture(GL_TEXTURE_BUFFER, m_TextureID);
+        glTexBuffer(GL_TEXTURE_BUFFER, format == TextureBufferFormat::R32UI ? GL_R32UI : GL_RGBA32F, m_BufferID);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    OpenGLTextureBuffer::~OpenGLTextureBuffer() {
+        HZ_PROFILE_FUNCTION();
+
+        glDeleteTextures(1, &m_TextureID);
+        glDeleteBuffers(1, &m_BufferID);
+    }
+
+    void OpenGLTextureBuffer::Bind(uint32_t slot) const {
+        glActiveTexture(GL_TEXTURE0 + slot);
+        glBindTexture(GL_TEXTURE_BUFFER, m_TextureID);
+    }
+
+    void OpenGLTextureBuffer::SetData(const void *data, uint32_t size) {
+        HZ_CORE_ASSERT(size <= m_Size, "Data larger than the TextureBuffer");
+
+        glBindBuffer(GL_TEXTURE_BUFFER, m_BufferID);
+        // 同一帧里会上传多个批次，orphan之后驱动分配新的存储，上一个批次的绘制可以继续读旧的
+        glBufferData(GL_TEXTURE_BUFFER, m_Size, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
     /////////////////////////////////////////////////////////////////////////////
     // IndexBuffer /////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////////////////////
@@ -66,6 +291,16 @@ namespace Hazel {
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(uint32_t), indices, GL_STATIC_DRAW);
     }
 
+    OpenGLIndexBuffer::OpenGLIndexBuffer(uint32_t count) : m_Count(count) {
+        HZ_PROFILE_FUNCTION();
+
+        glGenBuffers(1, &m_RendererID);
+        // 绑定到GL_ELEMENT_ARRAY_BUFFER会改掉当前顶点数组的索引缓冲，创建和上传都用GL_COPY_WRITE_BUFFER
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+        glBufferData(GL_COPY_WRITE_BUFFER, count * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
     OpenGLIndexBuffer::~OpenGLIndexBuffer() {
         HZ_PROFILE_FUNCTION();
 
@@ -83,4 +318,14 @@ namespace Hazel {
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
+
+    void OpenGLIndexBuffer::SetData(const uint32_t *indices, uint32_t count) {
+        HZ_CORE_ASSERT(count <= m_Count, "Too many indices for the IndexBuffer");
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+        // 一帧里会上传多个批次，先orphan，不等待上一个批次的绘制
+        glBufferData(GL_COPY_WRITE_BUFFER, m_Count * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, count * sizeof(uint32_t), indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
 }
\ No newline at end of file
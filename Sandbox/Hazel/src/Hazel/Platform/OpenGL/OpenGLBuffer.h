@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <vector>
 
 #include "Renderer/Buffer.h"
 
@@ -24,15 +25,73 @@ namespace Hazel {
 
         // 支持动态的设置顶点数据
         virtual void SetData(const void* data, uint32_t size) override;
+        virtual void SetSubData(const void* data, uint32_t size, uint32_t offset) override;
+
+        // transform feedback把结果直接写进这个缓冲
+        uint32_t GetRendererID() const { return m_RendererID; }
+
+    private:
+        uint32_t m_RendererID;
+        BufferLayout m_Layout;
+    };
+
+    class OpenGLStreamingVertexBuffer : public StreamingVertexBuffer {
+    public:
+        OpenGLStreamingVertexBuffer(uint32_t regionSize, uint32_t regionCount);
+        virtual ~OpenGLStreamingVertexBuffer();
+
+        void Bind() const override;
+        void Unbind() const override;
+
+        const BufferLayout &GetLayout() const override {
+            return m_Layout;
+        };
+
+        void SetLayout(const BufferLayout &layout) override {
+            m_Layout = layout;
+        };
+
+        // 写到当前区域的开头，绘制之后要调用Fence
+        virtual void SetData(const void* data, uint32_t size) override;
+        // 区域每次映射都会换位置，不支持局部更新
+        virtual void SetSubData(const void* data, uint32_t size, uint32_t offset) override;
+
+        void* Map() override;
+        uint32_t Unmap(uint32_t usedSize) override;
+        void Fence() override;
+
+        uint32_t GetRegionSize() const override { return m_RegionSize; }
+        uint32_t GetRegionOffset() const override { return m_CurrentRegion * m_RegionSize; }
+        bool IsPersistent() const override { return m_PersistentPtr != nullptr; }
+
+        const Statistics& GetStats() const override { return m_Stats; }
+        void ResetStats() override { m_Stats = Statistics(); }
+
+    private:
+        void WaitForRegion(uint32_t region);
+        void Orphan();
 
     private:
         uint32_t m_RendererID;
         BufferLayout m_Layout;
+
+        uint32_t m_RegionSize;
+        uint32_t m_RegionCount;
+        uint32_t m_CurrentRegion = 0;
+        bool m_Mapped = false;
+        // 持久映射时整个缓冲一直映射着，这里是起始地址
+        uint8_t* m_PersistentPtr = nullptr;
+        // GLsync，每个区域一个
+        std::vector<void*> m_Fences;
+
+        Statistics m_Stats;
     };
 
     class OpenGLIndexBuffer : public IndexBuffer {
     public:
         OpenGLIndexBuffer(uint32_t* indices, uint32_t count);
+        // 动态索引缓冲
+        OpenGLIndexBuffer(uint32_t count);
 
         virtual ~OpenGLIndexBuffer();
 
@@ -42,8 +101,26 @@ namespace Hazel {
 
         uint32_t GetCount() const override {return m_Count;}
 
+        void SetData(const uint32_t* indices, uint32_t count) override;
+
     private:
         uint32_t m_RendererID;
         uint32_t m_Count;
     };
+
+    class OpenGLTextureBuffer : public TextureBuffer {
+    public:
+        OpenGLTextureBuffer(uint32_t size, TextureBufferFormat format);
+        virtual ~OpenGLTextureBuffer();
+
+        void Bind(uint32_t slot = 0) const override;
+
+        void SetData(const void* data, uint32_t size) override;
+        uint32_t GetSize() const override { return m_Size; }
+
+    private:
+        uint32_t m_BufferID;
+        uint32_t m_TextureID;
+        uint32_t m_Size;
+    };
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 
 #include "Core/Base.h"
 #include "Debugger/Instrumentor.h"
+#include "Renderer/RenderCaps.h"
 
 const char *vertexShaderSource = "#version 330 core\n"
                                  "layout (location = 0) in vec3 aPos;\n"
@@ -39,6 +40,51 @@ namespace Hazel {
         HZ_CORE_INFO(" Vendor: {0}", (char*)glGetString(GL_VENDOR));
         HZ_CORE_INFO(" Renderer: {0}", (char*)glGetString(GL_RENDERER));
         HZ_CORE_INFO(" Version: {0}", (char*)glGetString(GL_VERSION));
+
+        QueryCaps();
+    }
+
+    static uint32_t GetInteger(GLenum name) {
+        GLint value = 0;
+        glGetIntegerv(name, &value);
+        return (uint32_t)value;
+    }
+
+    void OpenGLContext::QueryCaps() {
+        HZ_PROFILE_FUNCTION();
+
+        RenderCaps& caps = RenderCaps::Get();
+        caps.Vendor = (const char*)glGetString(GL_VENDOR);
+        caps.Renderer = (const char*)glGetString(GL_RENDERER);
+        caps.Version = (const char*)glGetString(GL_VERSION);
+        glGetIntegerv(GL_MAJOR_VERSION, &caps.VersionMajor);
+        glGetIntegerv(GL_MINOR_VERSION, &caps.VersionMinor);
+
+        caps.MaxTextureSlots = GetInteger(GL_MAX_TEXTURE_IMAGE_UNITS);
+        caps.MaxCombinedTextureSlots = GetInteger(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS);
+        caps.MaxTextureSize = GetInteger(GL_MAX_TEXTURE_SIZE);
+        caps.MaxArrayTextureLayers = GetInteger(GL_MAX_ARRAY_TEXTURE_LAYERS);
+        caps.MaxUniformBlockSize = GetInteger(GL_MAX_UNIFORM_BLOCK_SIZE);
+        caps.MaxVertexAttribs = GetInteger(GL_MAX_VERTEX_ATTRIBS);
+        caps.MaxTextureBufferSize = GetInteger(GL_MAX_TEXTURE_BUFFER_SIZE);
+        caps.MaxElementsVertices = GetInteger(GL_MAX_ELEMENTS_VERTICES);
+        caps.MaxElementsIndices = GetInteger(GL_MAX_ELEMENTS_INDICES);
+
+        uint32_t extensionCount = GetInteger(GL_NUM_EXTENSIONS);
+        caps.Extensions.clear();
+        caps.Extensions.reserve(extensionCount);
+        for (uint32_t i = 0; i < extensionCount; i++) {
+            caps.Extensions.push_back((const char*)glGetStringi(GL_EXTENSIONS, i));
+        }
+
+        caps.BufferStorage = caps.IsVersionAtLeast(4, 4) || caps.HasExtension("GL_ARB_buffer_storage");
+        caps.MultiDrawIndirect = caps.IsVersionAtLeast(4, 3) || caps.HasExtension("GL_ARB_multi_draw_indirect");
+        caps.ParallelShaderCompile = caps.HasExtension("GL_KHR_parallel_shader_compile") || caps.HasExtension("GL_ARB_parallel_shader_compile");
+
+        HZ_CORE_INFO(" Texture units: {0}, max texture size: {1}, array layers: {2}, uniform block: {3}",
+                     caps.MaxTextureSlots, caps.MaxTextureSize, caps.MaxArrayTextureLayers, caps.MaxUniformBlockSize);
+        HZ_CORE_INFO(" Buffer storage: {0}, multi draw indirect: {1}, parallel shader compile: {2}",
+                     caps.BufferStorage, caps.MultiDrawIndirect, caps.ParallelShaderCompile);
     }
 
     void OpenGLContext::SwapBuffers() {
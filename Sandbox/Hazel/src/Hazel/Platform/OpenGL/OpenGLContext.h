@@ -12,6 +12,10 @@ namespace Hazel {
         virtual void Init() override;
         virtual void SwapBuffers() override;
 
+    private:
+        // 查询GL的限制和扩展，填充RenderCaps
+        void QueryCaps();
+
     private:
         GLFWwindow* m_WindowHandle;
     };
@@ -28,8 +28,27 @@ namespace Hazel{
     }
 
     void OpenGLRendererAPI::DrawIndexed(const Ref<VertexArray> &vertexArray, uint32_t indexCount) {
-        uint32_t count = indexCount ? vertexArray->GetIndexBuffer()->GetCount() : indexCount;
+        uint32_t count = indexCount ? indexCount : vertexArray->GetIndexBuffer()->GetCount();
         glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
         glBindTexture(GL_TEXTURE_2D, 0);
     }
+
+    void OpenGLRendererAPI::DrawIndexedInstanced(const Ref<VertexArray> &vertexArray, uint32_t indexCount, uint32_t instanceCount) {
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr, instanceCount);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void OpenGLRendererAPI::DrawIndexedBaseVertex(const Ref<VertexArray> &vertexArray, uint32_t indexCount, uint32_t baseVertex) {
+        glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr, (GLint)baseVertex);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void OpenGLRendererAPI::DrawArrays(const Ref<VertexArray> &vertexArray, uint32_t vertexCount) {
+        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void OpenGLRendererAPI::SetDepthWrite(bool enabled) {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
 }
\ No newline at end of file
@@ -9,5 +9,9 @@ namespace Hazel {
         void SetClearColor(const glm::vec4& color) override;
         void Clear() override;
         void DrawIndexed(const std::shared_ptr<VertexArray>& vertexArray, uint32_t indexCount = 0) override;
+        void DrawIndexedInstanced(const std::shared_ptr<VertexArray>& vertexArray, uint32_t indexCount, uint32_t instanceCount) override;
+        void DrawIndexedBaseVertex(const std::shared_ptr<VertexArray>& vertexArray, uint32_t indexCount, uint32_t baseVertex) override;
+        void DrawArrays(const std::shared_ptr<VertexArray>& vertexArray, uint32_t vertexCount) override;
+        void SetDepthWrite(bool enabled) override;
     };
 }
\ No newline at end of file
@@ -21,6 +21,10 @@ namespace Hazel{
             return GL_FRAGMENT_SHADER;
         }
 
+        if (type == "geometry") {
+            return GL_GEOMETRY_SHADER;
+        }
+
         HZ_CORE_ASSERT(false, "Unknown shader type!");
         return 0;
     }
@@ -79,12 +83,13 @@ namespace Hazel{
         return shaderSource;
     }
 
-    void OpenGLShader::Compile(const std::unordered_map<GLenum, std::string> &shaderSources) {
+    void OpenGLShader::Compile(const std::unordered_map<GLenum, std::string> &shaderSources,
+                               const std::vector<std::string> &feedbackVaryings) {
         HZ_PROFILE_FUNCTION();
 
         GLuint program = glCreateProgram();
-        HZ_CORE_ASSERT(shaderSources.size() <= 2, "we only support 2 shaders for now");
-        std::array<GLenum, 2> glShaderIDs;
+        HZ_CORE_ASSERT(shaderSources.size() <= 3, "we only support 3 shaders for now");
+        std::array<GLenum, 3> glShaderIDs;
         int glShaderIDIndex = 0;
         for (auto& kv : shaderSources) {
             GLenum type = kv.first;
@@ -113,6 +118,14 @@ namespace Hazel{
         }
 
         m_RendererID = program;
+        // transform feedback的输出变量必须在链接之前指定，按顺序紧挨着写进同一个缓冲
+        if (!feedbackVaryings.empty()) {
+            std::vector<const GLchar*> names;
+            for (auto& name : feedbackVaryings) {
+                names.push_back(name.c_str());
+            }
+            glTransformFeedbackVaryings(program, (GLsizei)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS);
+        }
         glLinkProgram(program);
         GLint isLinked = 0;
         glGetProgramiv(program, GL_LINK_STATUS, (int*)&isLinked);
@@ -122,24 +135,57 @@ namespace Hazel{
             std::vector<GLchar> infoLog(maxLength);
             glGetProgramInfoLog(program, maxLength, &maxLength, &infoLog[0]);
             glDeleteProgram(program);
-            for (auto id : glShaderIDs) {
-                glDeleteShader(id);
+            for (int i = 0; i < glShaderIDIndex; i++) {
+                glDeleteShader(glShaderIDs[i]);
             }
             HZ_CORE_ERROR("{0}", infoLog.data());
             HZ_CORE_ASSERT(false, "Shader link failure!");
             return;
         }
-        for (auto id : glShaderIDs) {
-            glDetachShader(program, id);
+        for (int i = 0; i < glShaderIDIndex; i++) {
+            glDetachShader(program, glShaderIDs[i]);
+        }
+    }
+
+    void OpenGLShader::InjectDefines(std::unordered_map<GLenum, std::string> &shaderSources, const std::vector<std::string> &defines) {
+        if (defines.empty()) {
+            return;
+        }
+
+        std::string block;
+        for (auto& define : defines) {
+            block += "#define " + define + "\n";
+        }
+
+        // #version必须是第一条语句，宏只能放在它后面
+        for (auto& kv : shaderSources) {
+            std::string& source = kv.second;
+            size_t pos = source.find("#version");
+            size_t eol = pos == std::string::npos ? std::string::npos : source.find_first_of("\r\n", pos);
+            if (eol == std::string::npos) {
+                source.insert(0, block);
+                continue;
+            }
+            size_t next = source.find_first_not_of("\r\n", eol);
+            source.insert(next == std::string::npos ? source.size() : next, block);
         }
     }
 
-     OpenGLShader::OpenGLShader(const std::string &filePath) {
+     OpenGLShader::OpenGLShader(const std::string &filePath) : OpenGLShader(filePath, {}) {
+    }
+
+     OpenGLShader::OpenGLShader(const std::string &filePath, const std::vector<std::string> &defines)
+             : OpenGLShader(filePath, defines, {}) {
+    }
+
+     OpenGLShader::OpenGLShader(const std::string &filePath, const std::vector<std::string> &defines,
+                                const std::vector<std::string> &feedbackVaryings) {
         HZ_PROFILE_FUNCTION();
 
         std::string source = ReadFile(filePath);
         auto ShaderSources = PreProcess(source);
-        Compile(ShaderSources);
+        InjectDefines(ShaderSources, defines);
+        Compile(ShaderSources, feedbackVaryings);
 
         // 以文件名作为shader名字
         // Extract name from filepath
@@ -11,6 +11,9 @@ namespace Hazel {
     public:
         // 支持参数为文件路径的构造函数
         OpenGLShader(const std::string& filePath);
+        OpenGLShader(const std::string& filePath, const std::vector<std::string>& defines);
+        // feedbackVaryings不为空时按顺序捕获这些输出变量（transform feedback），只有OpenGL后端内部使用
+        OpenGLShader(const std::string& filePath, const std::vector<std::string>& defines, const std::vector<std::string>& feedbackVaryings);
         OpenGLShader(const std::string name, const std::string& vertexSrc, const std::string& fragmentSrc);
         ~OpenGLShader();
 
@@ -41,8 +44,10 @@ namespace Hazel {
         std::string ReadFile(const std::string& filePath);
         // shader存储到map中, key为shader类别
         std::unordered_map<GLenum, std::string> PreProcess(const std::string& source);
+        // 在每个阶段的#version之后插入宏定义，生成shader变体
+        void InjectDefines(std::unordered_map<GLenum, std::string>& shaderSources, const std::vector<std::string>& defines);
         // 编译Shader生成Shader program
-        void Compile(const std::unordered_map<GLenum, std::string>& shaderSources);
+        void Compile(const std::unordered_map<GLenum, std::string>& shaderSources, const std::vector<std::string>& feedbackVaryings = {});
 
     private:
         uint32_t m_RendererID;
@@ -0,0 +1,84 @@
+#include "OpenGLSpriteCuller.h"
+
+#include <memory>
+
+#include <glad/glad.h>
+
+#include "Base.h"
+#include "OpenGLBuffer.h"
+#include "Debugger/Instrumentor.h"
+
+namespace Hazel {
+
+    // 所有剔除器共用一个program，最后一个剔除器销毁时释放
+    static Ref<OpenGLShader> GetCullShader() {
+        static std::weak_ptr<OpenGLShader> s_Shader;
+        Ref<OpenGLShader> shader = s_Shader.lock();
+        if (!shader) {
+            // 输出变量的顺序就是QuadInstance的成员顺序
+            shader = CreateRef<OpenGLShader>("../assets/shaders/SpriteCull.glsl", std::vector<std::string>(),
+                                             std::vector<std::string>{"o_Position", "o_Size", "o_Rotation", "o_Color",
+                                                                      "o_TexRect", "o_TexIndex", "o_TilingFactor"});
+            s_Shader = shader;
+        }
+        return shader;
+    }
+
+    OpenGLSpriteCuller::OpenGLSpriteCuller() {
+        HZ_PROFILE_FUNCTION();
+
+        m_Shader = GetCullShader();
+        glGenQueries(TargetCount, m_Queries.data());
+    }
+
+    OpenGLSpriteCuller::~OpenGLSpriteCuller() {
+        HZ_PROFILE_FUNCTION();
+
+        glDeleteQueries(TargetCount, m_Queries.data());
+    }
+
+    void OpenGLSpriteCuller::Cull(uint32_t target, const Ref<VertexArray> &source, uint32_t count, const Ref<VertexBuffer> &output,
+                                  const glm::vec2 &viewMin, const glm::vec2 &viewMax) {
+        HZ_PROFILE_FUNCTION();
+
+        HZ_CORE_ASSERT(target < TargetCount, "Invalid cull target!");
+        m_Shader->Bind();
+        m_Shader->UploadUniformFloat4("u_ViewBounds", {viewMin.x, viewMin.y, viewMax.x, viewMax.y});
+        source->Bind();
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, std::static_pointer_cast<OpenGLVertexBuffer>(output)->GetRendererID());
+
+        // 只需要geometry shader的输出，不光栅化；count为0时也执行查询，之后的读取结果为0
+        glEnable(GL_RASTERIZER_DISCARD);
+        glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, m_Queries[target]);
+        glBeginTransformFeedback(GL_POINTS);
+        glDrawArrays(GL_POINTS, 0, count);
+        glEndTransformFeedback();
+        glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+        glDisable(GL_RASTERIZER_DISCARD);
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    }
+
+    bool OpenGLSpriteCuller::PollResult(uint32_t target, uint32_t &count) {
+        HZ_CORE_ASSERT(target < TargetCount, "Invalid cull target!");
+
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(m_Queries[target], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            return false;
+        }
+        GLuint written = 0;
+        glGetQueryObjectuiv(m_Queries[target], GL_QUERY_RESULT, &written);
+        count = written;
+        return true;
+    }
+
+    uint32_t OpenGLSpriteCuller::WaitResult(uint32_t target) {
+        HZ_PROFILE_FUNCTION();
+
+        HZ_CORE_ASSERT(target < TargetCount, "Invalid cull target!");
+        // 3.x没有glDrawTransformFeedbackInstanced（4.2），实例数只能读回来
+        GLuint written = 0;
+        glGetQueryObjectuiv(m_Queries[target], GL_QUERY_RESULT, &written);
+        return written;
+    }
+}
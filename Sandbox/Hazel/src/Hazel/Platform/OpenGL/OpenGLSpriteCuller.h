@@ -0,0 +1,24 @@
+#pragma once
+
+#include <array>
+
+#include "OpenGLShader.h"
+#include "Renderer/SpriteCuller.h"
+
+namespace Hazel {
+    class OpenGLSpriteCuller : public SpriteCuller {
+    public:
+        OpenGLSpriteCuller();
+        ~OpenGLSpriteCuller() override;
+
+        void Cull(uint32_t target, const Ref<VertexArray>& source, uint32_t count, const Ref<VertexBuffer>& output,
+                  const glm::vec2& viewMin, const glm::vec2& viewMax) override;
+        bool PollResult(uint32_t target, uint32_t& count) override;
+        uint32_t WaitResult(uint32_t target) override;
+
+    private:
+        Ref<OpenGLShader> m_Shader;
+        // 每个target一个GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN查询，得到写进输出缓冲的记录数
+        std::array<uint32_t, TargetCount> m_Queries = {};
+    };
+}
@@ -30,6 +30,7 @@ namespace Hazel {
 
         m_InternalFormat = internalFormat;
         m_DataFormat = dataFormat;
+        m_BytesPerPixel = channels;
         
         HZ_CORE_ASSERT(internalFormat && dataFormat, "Format not supported!")
 
@@ -56,17 +57,55 @@ namespace Hazel {
         stbi_image_free(data);
     }
 
-    OpenGLTexture2D::OpenGLTexture2D(uint32_t width, uint32_t height)
+    OpenGLTexture2D::OpenGLTexture2D(uint32_t width, uint32_t height, TextureFormat format)
         : m_width(width), m_height(height)
     {
         HZ_PROFILE_FUNCTION();
 
-        m_InternalFormat = GL_RGBA8;
-        m_DataFormat = GL_RGBA;
+        switch (format) {
+            case TextureFormat::RGBA8:
+                m_InternalFormat = GL_RGBA8;
+                m_DataFormat = GL_RGBA;
+                m_DataType = GL_UNSIGNED_BYTE;
+                m_BytesPerPixel = 4;
+                break;
+            case TextureFormat::R16UI:
+                m_InternalFormat = GL_R16UI;
+                m_DataFormat = GL_RED_INTEGER;
+                m_DataType = GL_UNSIGNED_SHORT;
+                m_BytesPerPixel = 2;
+                break;
+            case TextureFormat::R8:
+                m_InternalFormat = GL_R8;
+                m_DataFormat = GL_RED;
+                m_DataType = GL_UNSIGNED_BYTE;
+                m_BytesPerPixel = 1;
+                break;
+        }
         glGenTextures(1, &m_RendererID);
 
         glBindTexture(GL_TEXTURE_2D, m_RendererID);
-        glTexImage2D(GL_TEXTURE_2D, 0, m_InternalFormat, width, height, 0, m_DataFormat, GL_UNSIGNED_BYTE, nullptr);
+        glTexImage2D(GL_TEXTURE_2D, 0, m_InternalFormat, width, height, 0, m_DataFormat, m_DataType, nullptr);
+
+        if (format == TextureFormat::R16UI) {
+            // 整数纹理不能线性过滤，否则纹理不完整，采样结果为0
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            return;
+        }
+
+        if (format == TextureFormat::R8) {
+            // 唯一的通道读到alpha里，rgb为1；距离场放大时靠线性插值得到平滑的边缘，最近点采样会出现台阶
+            const GLint swizzle[4] = {GL_ONE, GL_ONE, GL_ONE, GL_RED};
+            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            return;
+        }
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -94,11 +133,76 @@ namespace Hazel {
     void OpenGLTexture2D::SetData(void *data, uint32_t size) {
         HZ_PROFILE_FUNCTION();
         
-        uint32_t bpp = m_DataFormat == GL_RGBA ? 4 : 3;
-        HZ_CORE_ASSERT(size == m_width * m_height * bpp, "Data must be entire");
+        HZ_CORE_ASSERT(size == m_width * m_height * m_BytesPerPixel, "Data must be entire");
+
+        glBindTexture(GL_TEXTURE_2D, m_RendererID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, m_BytesPerPixel == 4 ? 4 : 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, m_DataFormat, m_DataType, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    void OpenGLTexture2D::SetSubData(const void *data, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+        HZ_PROFILE_FUNCTION();
+
+        HZ_CORE_ASSERT(x + width <= m_width && y + height <= m_height, "Region out of texture bounds");
 
         glBindTexture(GL_TEXTURE_2D, m_RendererID);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, m_DataFormat, GL_UNSIGNED_BYTE, data);
+        // RGB和R16UI的行宽不一定是4字节对齐
+        glPixelStorei(GL_UNPACK_ALIGNMENT, m_BytesPerPixel == 4 ? 4 : 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, m_DataFormat, m_DataType, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Texture2DArray ///////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    OpenGLTexture2DArray::OpenGLTexture2DArray(uint32_t width, uint32_t height, uint32_t layers)
+        : m_Width(width), m_Height(height), m_LayerCount(layers)
+    {
+        HZ_PROFILE_FUNCTION();
+
+        glGenTextures(1, &m_RendererID);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    }
+
+    OpenGLTexture2DArray::~OpenGLTexture2DArray() {
+        HZ_PROFILE_FUNCTION();
+
+        glDeleteTextures(1, &m_RendererID);
+    }
+
+    void OpenGLTexture2DArray::SetData(void *data, uint32_t size) {
+        HZ_PROFILE_FUNCTION();
+
+        HZ_CORE_ASSERT(size == m_Width * m_Height * 4 * m_LayerCount, "Data must be entire");
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, m_Width, m_Height, m_LayerCount, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    }
+
+    void OpenGLTexture2DArray::SetLayerData(uint32_t layer, const void *data, uint32_t size) {
+        HZ_PROFILE_FUNCTION();
+
+        HZ_CORE_ASSERT(layer < m_LayerCount, "Layer out of range");
+        HZ_CORE_ASSERT(size == m_Width * m_Height * 4, "Data must be an entire layer");
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_Width, m_Height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    }
+
+    void OpenGLTexture2DArray::Bind(uint32_t slot) const {
+        HZ_PROFILE_FUNCTION();
+
+        glActiveTexture(GL_TEXTURE0 + slot);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
     }
 
 }
\ No newline at end of file
@@ -11,13 +11,17 @@ namespace Hazel {
     class OpenGLTexture2D : public Texture2D{
     public:
         explicit OpenGLTexture2D(const std::string& path);
-        OpenGLTexture2D(uint32_t width, uint32_t height);
+        OpenGLTexture2D(uint32_t width, uint32_t height, TextureFormat format = TextureFormat::RGBA8);
         ~OpenGLTexture2D() override;
 
         uint32_t GetWidth() const override { return m_width;}
         uint32_t GetHeight() const override { return m_height;}
+        uint32_t GetRendererID() const override { return m_RendererID; }
+        // R8的通道就是alpha
+        bool HasAlpha() const override { return m_DataFormat == GL_RGBA || m_DataFormat == GL_RED; }
 
         void SetData(void *data, uint32_t size) override;
+        void SetSubData(const void *data, uint32_t x, uint32_t y, uint32_t width, uint32_t height) override;
         void Bind(uint32_t slot = 0) const override;
 
         bool operator==(const Texture &other) const override{
@@ -31,5 +35,31 @@ namespace Hazel {
 
         GLint m_InternalFormat = 0;
         GLenum m_DataFormat = 0;
+        GLenum m_DataType = GL_UNSIGNED_BYTE;
+        uint32_t m_BytesPerPixel = 4;
+    };
+
+    class OpenGLTexture2DArray : public Texture2DArray {
+    public:
+        OpenGLTexture2DArray(uint32_t width, uint32_t height, uint32_t layers);
+        ~OpenGLTexture2DArray() override;
+
+        uint32_t GetWidth() const override { return m_Width; }
+        uint32_t GetHeight() const override { return m_Height; }
+        uint32_t GetLayerCount() const override { return m_LayerCount; }
+        uint32_t GetRendererID() const override { return m_RendererID; }
+        bool HasAlpha() const override { return true; }
+
+        void SetData(void *data, uint32_t size) override;
+        void SetLayerData(uint32_t layer, const void *data, uint32_t size) override;
+        void Bind(uint32_t slot = 0) const override;
+
+        bool operator==(const Texture &other) const override {
+            return m_RendererID == other.GetRendererID();
+        }
+
+    private:
+        uint32_t m_Width, m_Height, m_LayerCount;
+        uint32_t m_RendererID;
     };
 }
\ No newline at end of file
@@ -19,6 +19,10 @@ namespace Hazel{
             case ShaderDataType::Int3:          return GL_INT;
             case ShaderDataType::Int4:          return GL_INT;
             case ShaderDataType::Bool:          return GL_BOOL;
+            case ShaderDataType::UByte4Norm:    return GL_UNSIGNED_BYTE;
+            case ShaderDataType::Half2:         return GL_HALF_FLOAT;
+            case ShaderDataType::UShort2Norm:   return GL_UNSIGNED_SHORT;
+            case ShaderDataType::UByte:         return GL_UNSIGNED_BYTE;
         }
         HZ_CORE_ASSERT(false, "Unknow ShaderDataType!");
         return 0;
@@ -56,17 +60,65 @@ namespace Hazel{
         glBindVertexArray(m_RendererID);
         vertexBuffer->Bind();
 
-        uint32_t index = 0;
+        // 属性索引在多个顶点缓冲之间连续编号，比如逐顶点缓冲占用0~4，实例缓冲从5开始
         const auto& layout = vertexBuffer->GetLayout();
         for (const auto& element : layout) {
-            glEnableVertexAttribArray(index);
-            glVertexAttribPointer(index,
-                                  element.GetComponentCount(),
-                                  ShaderDataTypeToOpenGLBaseType(element.Type),
-                                  element.Normallized ? GL_TRUE : GL_FALSE,
-                                  layout.GetStride(),
-                                  (const void*)element.Offset);
-            index++;
+            switch (element.Type) {
+                case ShaderDataType::Float:
+                case ShaderDataType::Float2:
+                case ShaderDataType::Float3:
+                case ShaderDataType::Float4:
+                case ShaderDataType::UByte4Norm:
+                case ShaderDataType::Half2:
+                case ShaderDataType::UShort2Norm: {
+                    glEnableVertexAttribArray(m_VertexBufferIndex);
+                    glVertexAttribPointer(m_VertexBufferIndex,
+                                          element.GetComponentCount(),
+                                          ShaderDataTypeToOpenGLBaseType(element.Type),
+                                          element.Normallized ? GL_TRUE : GL_FALSE,
+                                          layout.GetStride(),
+                                          (const void*)(uintptr_t)element.Offset);
+                    glVertexAttribDivisor(m_VertexBufferIndex, layout.GetDivisor());
+                    m_VertexBufferIndex++;
+                    break;
+                }
+                case ShaderDataType::Int:
+                case ShaderDataType::Int2:
+                case ShaderDataType::Int3:
+                case ShaderDataType::Int4:
+                case ShaderDataType::Bool:
+                case ShaderDataType::UByte: {
+                    // 整型属性必须用glVertexAttribIPointer，否则shader里读到的是转换后的浮点数
+                    glEnableVertexAttribArray(m_VertexBufferIndex);
+                    glVertexAttribIPointer(m_VertexBufferIndex,
+                                           element.GetComponentCount(),
+                                           ShaderDataTypeToOpenGLBaseType(element.Type),
+                                           layout.GetStride(),
+                                           (const void*)(uintptr_t)element.Offset);
+                    glVertexAttribDivisor(m_VertexBufferIndex, layout.GetDivisor());
+                    m_VertexBufferIndex++;
+                    break;
+                }
+                case ShaderDataType::Mat3:
+                case ShaderDataType::Mat4: {
+                    // 矩阵按列占用多个属性位置
+                    uint8_t count = element.GetComponentCount() == 9 ? 3 : 4;
+                    for (uint8_t i = 0; i < count; i++) {
+                        glEnableVertexAttribArray(m_VertexBufferIndex);
+                        glVertexAttribPointer(m_VertexBufferIndex,
+                                              count,
+                                              ShaderDataTypeToOpenGLBaseType(element.Type),
+                                              element.Normallized ? GL_TRUE : GL_FALSE,
+                                              layout.GetStride(),
+                                              (const void*)(uintptr_t)(element.Offset + sizeof(float) * count * i));
+                        glVertexAttribDivisor(m_VertexBufferIndex, layout.GetDivisor());
+                        m_VertexBufferIndex++;
+                    }
+                    break;
+                }
+                default:
+                    HZ_CORE_ASSERT(false, "Unknow ShaderDataType!");
+            }
         }
         m_VertexBuffers.push_back(vertexBuffer);
     }
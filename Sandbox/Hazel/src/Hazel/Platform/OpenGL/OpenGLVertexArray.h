@@ -26,6 +26,7 @@ namespace Hazel {
 
     private:
         uint32_t m_RendererID;
+        uint32_t m_VertexBufferIndex = 0;
         std::vector<std::shared_ptr<VertexBuffer>> m_VertexBuffers;
         std::shared_ptr<IndexBuffer> m_IndexBuffer;
     };
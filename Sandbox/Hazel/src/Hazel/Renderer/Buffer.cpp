@@ -35,6 +35,30 @@ namespace Hazel {
         return nullptr;
     }
 
+    Ref<StreamingVertexBuffer> StreamingVertexBuffer::Create(uint32_t regionSize, uint32_t regionCount) {
+        switch (Renderer::GetAPI()) {
+            case RendererAPI::API::None: HZ_CORE_ASSERT(false, "RendererAPI::None is currently not supported!")
+                return nullptr;
+            case RendererAPI::API::OpenGL:
+                return CreateRef<OpenGLStreamingVertexBuffer>(regionSize, regionCount);
+        }
+
+        HZ_CORE_ASSERT(false, "Unknow RendererAPI!");
+        return nullptr;
+    }
+
+    Ref<TextureBuffer> TextureBuffer::Create(uint32_t size, TextureBufferFormat format) {
+        switch (Renderer::GetAPI()) {
+            case RendererAPI::API::None: HZ_CORE_ASSERT(false, "RendererAPI::None is currently not supported!")
+                return nullptr;
+            case RendererAPI::API::OpenGL:
+                return CreateRef<OpenGLTextureBuffer>(size, format);
+        }
+
+        HZ_CORE_ASSERT(false, "Unknow RendererAPI!");
+        return nullptr;
+    }
+
     Ref<IndexBuffer> IndexBuffer::Create(uint32_t *indices, uint32_t size) {
         switch (Renderer::GetAPI()) {
             case RendererAPI::API::None: HZ_CORE_ASSERT(false, "RendererAPI::None is currently not supported!")
@@ -46,4 +70,16 @@ namespace Hazel {
         HZ_CORE_ASSERT(false, "Unknow RendererAPI!");
         return nullptr;
     }
+
+    Ref<IndexBuffer> IndexBuffer::Create(uint32_t count) {
+        switch (Renderer::GetAPI()) {
+            case RendererAPI::API::None: HZ_CORE_ASSERT(false, "RendererAPI::None is currently not supported!")
+                return nullptr;
+            case RendererAPI::API::OpenGL:
+                return CreateRef<OpenGLIndexBuffer>(count);
+        }
+
+        HZ_CORE_ASSERT(false, "Unknow RendererAPI!");
+        return nullptr;
+    }
 }
\ No newline at end of file
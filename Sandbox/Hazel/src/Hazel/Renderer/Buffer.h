@@ -8,7 +8,9 @@
 
 namespace Hazel {
     enum class ShaderDataType {
-        None = 0, Float, Float2, Float3, Float4, Mat3, Mat4, Int, Int2, Int3, Int4, Bool
+        None = 0, Float, Float2, Float3, Float4, Mat3, Mat4, Int, Int2, Int3, Int4, Bool,
+        // 压缩类型：UByte4Norm/UShort2Norm在shader里读到的是[0,1]的浮点数，Half2是两个半精度浮点，UByte是整数
+        UByte4Norm, Half2, UShort2Norm, UByte
     };
 
     static uint32_t ShaderDataTypeSize(ShaderDataType type) {
@@ -24,6 +26,10 @@ namespace Hazel {
             case ShaderDataType::Int3:          return 4 * 3;
             case ShaderDataType::Int4:          return 4 * 4;
             case ShaderDataType::Bool:          return 1;
+            case ShaderDataType::UByte4Norm:    return 1 * 4;
+            case ShaderDataType::Half2:         return 2 * 2;
+            case ShaderDataType::UShort2Norm:   return 2 * 2;
+            case ShaderDataType::UByte:         return 1;
         }
 
         HZ_CORE_ASSERT(false, "Unknow ShaderDataType!")
@@ -40,7 +46,8 @@ namespace Hazel {
         BufferElement(){}
 
         BufferElement( ShaderDataType type, const std::string &name,bool normallized = false)
-                : Name(name), Type(type), Size(ShaderDataTypeSize(type)), Offset(0), Normallized(normallized) {}
+                : Name(name), Type(type), Size(ShaderDataTypeSize(type)), Offset(0),
+                  Normallized(normallized || type == ShaderDataType::UByte4Norm || type == ShaderDataType::UShort2Norm) {}
 
         uint32_t GetComponentCount() const {
             switch (Type) {
@@ -55,6 +62,10 @@ namespace Hazel {
                 case ShaderDataType::Int3:          return 3;
                 case ShaderDataType::Int4:          return 4;
                 case ShaderDataType::Bool:          return 1;
+                case ShaderDataType::UByte4Norm:    return 4;
+                case ShaderDataType::Half2:         return 2;
+                case ShaderDataType::UShort2Norm:   return 2;
+                case ShaderDataType::UByte:         return 1;
             }
             HZ_CORE_ASSERT(false, "Unknow ShaderDataType!");
             return 0;
@@ -68,8 +79,13 @@ namespace Hazel {
         BufferLayout(const std::initializer_list<BufferElement>& elements):m_Elements(elements) {
             CalculateOffsetsAndStride();
         }
+        // divisor不为0时按实例推进属性，1表示每个实例取一次
+        BufferLayout(const std::initializer_list<BufferElement>& elements, uint32_t divisor):m_Elements(elements), m_Divisor(divisor) {
+            CalculateOffsetsAndStride();
+        }
 
         inline uint32_t GetStride() const {return m_Stride;}
+        inline uint32_t GetDivisor() const {return m_Divisor;}
         inline const std::vector<BufferElement>& GetElements() const {return m_Elements;}
 
         std::vector<BufferElement>::iterator begin() {return m_Elements.begin();}
@@ -90,6 +106,7 @@ namespace Hazel {
     private:
         std::vector<BufferElement> m_Elements;
         uint32_t m_Stride = 0;
+        uint32_t m_Divisor = 0;
     };
 
     class VertexBuffer {
@@ -103,11 +120,45 @@ namespace Hazel {
         virtual void SetLayout(const BufferLayout& layout) = 0;
         
         virtual void SetData(const void* data, uint32_t size) = 0;
+        // 只更新从offset字节开始的size字节
+        virtual void SetSubData(const void* data, uint32_t size, uint32_t offset) = 0;
 
         static Ref<VertexBuffer> Create(uint32_t size);
         static Ref<VertexBuffer> Create(float* vertices, uint32_t size);
     };
 
+    // 流式顶点缓冲：多个区域组成的环形缓冲，CPU直接写入映射出来的区域，省掉一次暂存数组的拷贝
+    // 每个区域在被绘制之后插入fence，再次映射时如果GPU还没读完需要等待（或者orphan整个缓冲）
+    // SetData等价于Map、复制、Unmap：数据写在当前区域的开头（偏移为GetRegionOffset()），绘制之后同样要调用Fence切换区域；
+    // 区域每次映射都会换位置，不支持SetSubData
+    class StreamingVertexBuffer : public VertexBuffer {
+    public:
+        struct Statistics
+        {
+            uint32_t FenceWaits = 0; // CPU等待GPU的次数
+            float StallTime = 0.0f;  // 等待的总时间，单位ms
+            uint32_t Orphans = 0;    // 区域仍被占用时orphan整个缓冲的次数（非持久映射模式）
+        };
+
+        // 映射当前区域，返回的指针可以写入GetRegionSize()字节
+        virtual void* Map() = 0;
+        // 写完之后解除映射，返回当前区域在缓冲中的字节偏移
+        virtual uint32_t Unmap(uint32_t usedSize) = 0;
+        // 在读取当前区域的绘制命令之后调用，插入fence并切换到下一个区域
+        virtual void Fence() = 0;
+
+        virtual uint32_t GetRegionSize() const = 0;
+        // 当前区域在缓冲中的字节偏移，Fence之后变为下一个区域
+        virtual uint32_t GetRegionOffset() const = 0;
+        // 是否使用了持久映射（GL_ARB_buffer_storage），否则是unsynchronized映射加orphan
+        virtual bool IsPersistent() const = 0;
+
+        virtual const Statistics& GetStats() const = 0;
+        virtual void ResetStats() = 0;
+
+        static Ref<StreamingVertexBuffer> Create(uint32_t regionSize, uint32_t regionCount);
+    };
+
     class IndexBuffer {
     public:
         virtual ~IndexBuffer(){}
@@ -115,6 +166,34 @@ namespace Hazel {
         virtual void Bind() const = 0;
         virtual void Unbind() const = 0;
         virtual uint32_t GetCount() const = 0;
+        // 只对动态索引缓冲有效，count不能超过创建时的容量
+        virtual void SetData(const uint32_t* indices, uint32_t count) = 0;
+
         static Ref<IndexBuffer> Create(uint32_t* indices, uint32_t count);
+        // 动态索引缓冲，可以容纳count个索引，内容由SetData每次整体上传
+        static Ref<IndexBuffer> Create(uint32_t count);
+    };
+
+    // 纹理缓冲的纹素格式，shader里RGBA32F用samplerBuffer读取，R32UI用usamplerBuffer读取
+    enum class TextureBufferFormat
+    {
+        RGBA32F = 0, R32UI
+    };
+
+    // 纹理缓冲：一块按TextureBufferFormat解释纹素的缓冲，shader里用texelFetch按下标读取
+    // 顶点拉取时每个矩形的记录放在这里（RGBA32F），分块光照的光源和瓦片表也放在这里（RGBA32F和R32UI）
+    class TextureBuffer {
+    public:
+        virtual ~TextureBuffer(){}
+
+        // 绑定到纹理单元slot
+        virtual void Bind(uint32_t slot = 0) const = 0;
+
+        // 每次上传前丢弃旧的存储，不需要等待GPU读完上一次的数据
+        virtual void SetData(const void* data, uint32_t size) = 0;
+        virtual uint32_t GetSize() const = 0;
+
+        // size为字节数，必须是纹素大小的整数倍
+        static Ref<TextureBuffer> Create(uint32_t size, TextureBufferFormat format = TextureBufferFormat::RGBA32F);
     };
 }
\ No newline at end of file
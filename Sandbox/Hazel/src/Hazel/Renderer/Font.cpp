@@ -0,0 +1,214 @@
+#include "Font.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+// ImGui自带的stb_truetype，在imgui_draw.cpp里是static实现，这里再编译一份自己用
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imstb_truetype.h"
+
+#include "Base.h"
+#include "Log.h"
+#include "RenderCaps.h"
+#include "TextureAtlas.h"
+#include "Debugger/Instrumentor.h"
+
+namespace Hazel {
+
+    Font::Font(const std::string &path) {
+        Load(path);
+    }
+
+    Font::Font(const std::string &path, const Specification &spec) : m_Specification(spec) {
+        Load(path);
+    }
+
+    void Font::Load(const std::string &path) {
+        HZ_PROFILE_FUNCTION();
+
+        HZ_CORE_ASSERT(m_Specification.LastCodepoint >= m_Specification.FirstCodepoint, "Invalid font codepoint range!");
+        auto start = std::chrono::high_resolution_clock::now();
+
+        std::ifstream in(path, std::ios::in | std::ios::binary);
+        if (!in) {
+            HZ_CORE_ERROR("Could not open font '{0}'", path);
+            return;
+        }
+        const std::vector<unsigned char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        stbtt_fontinfo info;
+        if (data.empty() || !stbtt_InitFont(&info, data.data(), stbtt_GetFontOffsetForIndex(data.data(), 0))) {
+            HZ_CORE_ERROR("Failed to parse font '{0}'", path);
+            return;
+        }
+
+        const uint32_t first = m_Specification.FirstCodepoint;
+        const uint32_t glyphCount = m_Specification.LastCodepoint - first + 1;
+        const float pixelHeight = (float)m_Specification.PixelHeight;
+        const float scale = stbtt_ScaleForPixelHeight(&info, pixelHeight);
+        // 字体单位换算成字号单位
+        const float emScale = scale / pixelHeight;
+
+        int ascent, descent, lineGap;
+        stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
+        m_Ascent = ascent * emScale;
+        m_LineHeight = (ascent - descent + lineGap) * emScale;
+
+        struct Bitmap
+        {
+            std::vector<uint8_t> Pixels;
+            int Width = 0, Height = 0;
+            int XOffset = 0, YOffset = 0;
+        };
+        std::vector<Bitmap> bitmaps(glyphCount);
+        m_Glyphs.assign(glyphCount, Glyph());
+
+        // 字形的距离场互不相关，每个线程从计数器领取下一个字形；stbtt_fontinfo只读，可以多线程共用
+        const int spread = (int)m_Specification.Spread;
+        std::atomic<uint32_t> next{0};
+        auto generate = [&]() {
+            for (uint32_t i = next++; i < glyphCount; i = next++) {
+                const int codepoint = (int)(first + i);
+                int advance, bearing;
+                stbtt_GetCodepointHMetrics(&info, codepoint, &advance, &bearing);
+                m_Glyphs[i].Advance = advance * emScale;
+
+                // 边缘处的值为128，每向外（向内）一个像素减少（增加）128/spread
+                Bitmap& bitmap = bitmaps[i];
+                int width = 0, height = 0, xOffset = 0, yOffset = 0;
+                unsigned char* sdf = stbtt_GetCodepointSDF(&info, scale, codepoint, spread, 128, 128.0f / (float)spread,
+                                                           &width, &height, &xOffset, &yOffset);
+                if (sdf) {
+                    bitmap.Pixels.assign(sdf, sdf + width * height);
+                    bitmap.Width = width;
+                    bitmap.Height = height;
+                    bitmap.XOffset = xOffset;
+                    bitmap.YOffset = yOffset;
+                    stbtt_FreeSDF(sdf, nullptr);
+                }
+            }
+        };
+
+        uint32_t threadCount = m_Specification.ThreadCount ? m_Specification.ThreadCount : std::thread::hardware_concurrency();
+        threadCount = std::clamp(threadCount, 1u, glyphCount);
+        {
+            HZ_PROFILE_SCOPE("Font::GenerateDistanceFields");
+            std::vector<std::thread> workers;
+            for (uint32_t i = 1; i < threadCount; i++) {
+                workers.emplace_back(generate);
+            }
+            generate();
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+
+        // 按高度从高到低装箱，天际线的浪费更少；放不下时图集边长加倍
+        std::vector<uint32_t> order;
+        for (uint32_t i = 0; i < glyphCount; i++) {
+            if (!bitmaps[i].Pixels.empty()) {
+                order.push_back(i);
+            }
+        }
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return bitmaps[a].Height > bitmaps[b].Height; });
+
+        const uint32_t padding = 1;
+        const uint32_t maxSize = RenderCaps::Get().MaxTextureSize;
+        std::vector<uint32_t> xs(glyphCount), ys(glyphCount);
+        uint32_t atlasSize = 256;
+        SkylinePacker packer;
+        for (;;) {
+            packer.Reset(atlasSize, atlasSize);
+            bool packed = true;
+            for (uint32_t i : order) {
+                if (!packer.Insert(bitmaps[i].Width + padding, bitmaps[i].Height + padding, xs[i], ys[i])) {
+                    packed = false;
+                    break;
+                }
+            }
+            if (packed) {
+                break;
+            }
+            if (atlasSize * 2 > maxSize) {
+                HZ_CORE_ERROR("Font '{0}' does not fit into a {1}x{1} atlas", path, atlasSize);
+                m_Glyphs.clear();
+                return;
+            }
+            atlasSize *= 2;
+        }
+
+        // 单通道的距离场；stb的位图第一行在最上面，纹理的v轴向上，复制时上下翻转
+        std::vector<uint8_t> pixels((size_t)atlasSize * atlasSize, 0);
+        for (uint32_t i : order) {
+            const Bitmap& bitmap = bitmaps[i];
+            for (int row = 0; row < bitmap.Height; row++) {
+                uint8_t* dst = &pixels[(size_t)(ys[i] + bitmap.Height - 1 - row) * atlasSize + xs[i]];
+                memcpy(dst, &bitmap.Pixels[(size_t)row * bitmap.Width], bitmap.Width);
+            }
+
+            Glyph& glyph = m_Glyphs[i];
+            glyph.UVMin = {(float)xs[i] / atlasSize, (float)ys[i] / atlasSize};
+            glyph.UVMax = {(float)(xs[i] + bitmap.Width) / atlasSize, (float)(ys[i] + bitmap.Height) / atlasSize};
+            glyph.Offset = {bitmap.XOffset / pixelHeight, -(bitmap.YOffset + bitmap.Height) / pixelHeight};
+            glyph.Size = {bitmap.Width / pixelHeight, bitmap.Height / pixelHeight};
+        }
+
+        m_AtlasTexture = Texture2D::Create(atlasSize, atlasSize, TextureFormat::R8);
+        m_AtlasTexture->SetData(pixels.data(), atlasSize * atlasSize);
+
+        for (uint32_t a = 0; a < glyphCount; a++) {
+            for (uint32_t b = 0; b < glyphCount; b++) {
+                int kerning = stbtt_GetCodepointKernAdvance(&info, (int)(first + a), (int)(first + b));
+                if (kerning) {
+                    m_Kerning[((uint64_t)(first + a) << 32) | (first + b)] = kerning * emScale;
+                }
+            }
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        HZ_CORE_INFO("Font '{0}': {1} glyphs, {2}x{2} SDF atlas, {3} threads, {4} ms", path, glyphCount, atlasSize, threadCount,
+                     std::chrono::duration<float, std::milli>(end - start).count());
+    }
+
+    const Font::Glyph* Font::GetGlyph(uint32_t codepoint) const {
+        if (codepoint < m_Specification.FirstCodepoint || codepoint - m_Specification.FirstCodepoint >= m_Glyphs.size()) {
+            return nullptr;
+        }
+        return &m_Glyphs[codepoint - m_Specification.FirstCodepoint];
+    }
+
+    float Font::GetKerning(uint32_t first, uint32_t second) const {
+        auto it = m_Kerning.find(((uint64_t)first << 32) | second);
+        return it != m_Kerning.end() ? it->second : 0.0f;
+    }
+
+    float Font::GetStringWidth(const std::string &text) const {
+        float width = 0.0f, lineWidth = 0.0f;
+        uint32_t previous = 0;
+        for (char c : text) {
+            const uint32_t codepoint = (uint8_t)c;
+            if (codepoint == '\n') {
+                width = std::max(width, lineWidth);
+                lineWidth = 0.0f;
+                previous = 0;
+                continue;
+            }
+            const Glyph* glyph = GetGlyph(codepoint);
+            if (!glyph) {
+                continue;
+            }
+            if (previous) {
+                lineWidth += GetKerning(previous, codepoint);
+            }
+            lineWidth += glyph->Advance;
+            previous = codepoint;
+        }
+        return std::max(width, lineWidth);
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Core.h"
+#include "Texture.h"
+
+namespace Hazel {
+
+    // TrueType字体：加载时把字符集里的每个字形光栅化成有向距离场(SDF)，多线程生成后打包进一张图集纹理
+    // 距离场放大缩小都能保持清晰的边缘，同一个字体的所有字号共用一张图集，由Renderer2D::DrawString和精灵一起批量绘制
+    // 字形的度量都以字号为单位（1.0为一行的高度），绘制时乘以实际字号
+    class Font {
+    public:
+        struct Specification
+        {
+            uint32_t PixelHeight = 48; // 光栅化时的字号，越大小字越清晰，图集也越大
+            uint32_t Spread = 6;       // 距离场向字形外扩展的像素数，决定描边/阴影等效果的最大宽度
+            uint32_t FirstCodepoint = 32;
+            uint32_t LastCodepoint = 126;
+            uint32_t ThreadCount = 0;  // 生成距离场的线程数，0为硬件线程数
+        };
+
+        struct Glyph
+        {
+            glm::vec2 UVMin = glm::vec2(0.0f);
+            glm::vec2 UVMax = glm::vec2(0.0f);
+            glm::vec2 Offset = glm::vec2(0.0f); // 矩形左下角相对基线上画笔位置的偏移
+            glm::vec2 Size = glm::vec2(0.0f);   // 为0时是空白字符，只前进不绘制
+            float Advance = 0.0f;
+        };
+
+        explicit Font(const std::string& path);
+        Font(const std::string& path, const Specification& spec);
+
+        bool IsLoaded() const { return m_AtlasTexture != nullptr; }
+
+        // 不在字符集里的字符返回nullptr
+        const Glyph* GetGlyph(uint32_t codepoint) const;
+        float GetKerning(uint32_t first, uint32_t second) const;
+        float GetLineHeight() const { return m_LineHeight; }
+        float GetAscent() const { return m_Ascent; }
+        // 单行文字的宽度，多行时取最宽的一行
+        float GetStringWidth(const std::string& text) const;
+
+        const Ref<Texture2D>& GetAtlasTexture() const { return m_AtlasTexture; }
+        const Specification& GetSpecification() const { return m_Specification; }
+
+    private:
+        void Load(const std::string& path);
+
+    private:
+        Specification m_Specification;
+        std::vector<Glyph> m_Glyphs; // 下标为codepoint - FirstCodepoint
+        std::unordered_map<uint64_t, float> m_Kerning; // (first << 32 | second)，只保存非0的字距调整
+        float m_LineHeight = 1.0f;
+        float m_Ascent = 0.0f;
+        Ref<Texture2D> m_AtlasTexture;
+    };
+}
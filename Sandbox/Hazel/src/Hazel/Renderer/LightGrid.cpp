@@ -0,0 +1,169 @@
+#include "LightGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Base.h"
+#include "RenderCaps.h"
+#include "Debugger/Instrumentor.h"
+
+namespace Hazel {
+
+    namespace {
+        // 不小于value的2的幂，不超过limit
+        uint32_t GrowCapacity(uint32_t value, uint32_t limit) {
+            uint32_t capacity = 64;
+            while (capacity < value) {
+                capacity *= 2;
+            }
+            return std::min(capacity, limit);
+        }
+    }
+
+    LightGrid::LightGrid(uint32_t tileSize) : m_TileSize(std::max(tileSize, 1u)) {
+    }
+
+    void LightGrid::Build(const OrthographicCamera &camera, uint32_t viewportWidth, uint32_t viewportHeight,
+                          const PointLight *lights, uint32_t count) {
+        Bin(camera, viewportWidth, viewportHeight, lights, count);
+        Upload();
+    }
+
+    bool LightGrid::CoversTile(const ScreenLight &light, int32_t x, int32_t y) const {
+        // 瓦片矩形上离圆心最近的点在圆内
+        const float tileSize = (float)m_TileSize;
+        const float dx = light.Center.x - std::clamp(light.Center.x, x * tileSize, (x + 1) * tileSize);
+        const float dy = light.Center.y - std::clamp(light.Center.y, y * tileSize, (y + 1) * tileSize);
+        return dx * dx + dy * dy <= light.Radius * light.Radius;
+    }
+
+    void LightGrid::Bin(const OrthographicCamera &camera, uint32_t viewportWidth, uint32_t viewportHeight,
+                        const PointLight *lights, uint32_t count) {
+        HZ_PROFILE_FUNCTION();
+
+        m_TilesX = std::max((viewportWidth + m_TileSize - 1) / m_TileSize, 1u);
+        m_TilesY = std::max((viewportHeight + m_TileSize - 1) / m_TileSize, 1u);
+        const uint32_t tileCount = m_TilesX * m_TilesY;
+        // 瓦片表和光源数据都受纹理缓冲大小的限制
+        const uint32_t maxTexels = RenderCaps::Get().MaxTextureBufferSize;
+        const uint32_t maxEntries = maxTexels > tileCount + 1 ? maxTexels - tileCount - 1 : 0;
+        const uint32_t maxLights = maxTexels / 2;
+
+        // 世界空间的单位长度在屏幕上的像素数；视口宽高比和相机不一致时圆会被拉伸，取较大的一边保证不漏掉瓦片
+        const glm::mat4& viewProjection = camera.GetViewProjectionMatrix();
+        const glm::vec2 halfViewport = {viewportWidth * 0.5f, viewportHeight * 0.5f};
+        const float scaleX = std::hypot(viewProjection[0][0] * halfViewport.x, viewProjection[0][1] * halfViewport.y);
+        const float scaleY = std::hypot(viewProjection[1][0] * halfViewport.x, viewProjection[1][1] * halfViewport.y);
+        const float pixelsPerUnit = std::max(scaleX, scaleY);
+
+        // 第一遍：求每个光源覆盖的瓦片，统计每个瓦片的光源数
+        m_ScreenLights.clear();
+        m_LightData.clear();
+        m_Cursors.assign(tileCount, 0);
+        m_TileEntryCount = 0;
+        m_DroppedLights = 0;
+        const float tileSize = (float)m_TileSize;
+        for (uint32_t i = 0; i < count; i++) {
+            const PointLight& light = lights[i];
+            if (light.Radius <= 0.0f || light.Intensity <= 0.0f) {
+                continue;
+            }
+            // 正交投影的w为1，裁剪坐标就是NDC；像素坐标和gl_FragCoord一样从左下角开始
+            const glm::vec4 clip = viewProjection * glm::vec4(light.Position.x, light.Position.y, 0.0f, 1.0f);
+            ScreenLight screen;
+            screen.Center = {(clip.x * 0.5f + 0.5f) * viewportWidth, (clip.y * 0.5f + 0.5f) * viewportHeight};
+            screen.Radius = light.Radius * pixelsPerUnit;
+            if (screen.Center.x + screen.Radius < 0.0f || screen.Center.x - screen.Radius > viewportWidth ||
+                screen.Center.y + screen.Radius < 0.0f || screen.Center.y - screen.Radius > viewportHeight) {
+                continue;
+            }
+            screen.MinX = std::max((int32_t)std::floor((screen.Center.x - screen.Radius) / tileSize), 0);
+            screen.MinY = std::max((int32_t)std::floor((screen.Center.y - screen.Radius) / tileSize), 0);
+            screen.MaxX = std::min((int32_t)std::floor((screen.Center.x + screen.Radius) / tileSize), (int32_t)m_TilesX - 1);
+            screen.MaxY = std::min((int32_t)std::floor((screen.Center.y + screen.Radius) / tileSize), (int32_t)m_TilesY - 1);
+
+            uint32_t covered = 0;
+            for (int32_t y = screen.MinY; y <= screen.MaxY; y++) {
+                for (int32_t x = screen.MinX; x <= screen.MaxX; x++) {
+                    if (CoversTile(screen, x, y)) {
+                        m_Cursors[y * m_TilesX + x]++;
+                        covered++;
+                    }
+                }
+            }
+            if (covered == 0) {
+                continue;
+            }
+            // 放不下时撤回这个光源的计数，后面的光源仍然可能放得下
+            if (m_ScreenLights.size() >= maxLights || m_TileEntryCount + covered > maxEntries) {
+                for (int32_t y = screen.MinY; y <= screen.MaxY; y++) {
+                    for (int32_t x = screen.MinX; x <= screen.MaxX; x++) {
+                        if (CoversTile(screen, x, y)) {
+                            m_Cursors[y * m_TilesX + x]--;
+                        }
+                    }
+                }
+                m_DroppedLights++;
+                continue;
+            }
+            m_TileEntryCount += covered;
+            m_ScreenLights.push_back(screen);
+            m_LightData.push_back({light.Position.x, light.Position.y, light.Radius, light.Intensity});
+            m_LightData.push_back({light.Color.r, light.Color.g, light.Color.b, 0.0f});
+        }
+        m_LightCount = (uint32_t)m_ScreenLights.size();
+
+        // 前缀和得到每个瓦片的起始位置，计数换成写入游标
+        m_Grid.resize(tileCount + 1 + m_TileEntryCount);
+        m_MaxLightsPerTile = 0;
+        uint32_t offset = tileCount + 1;
+        for (uint32_t tile = 0; tile < tileCount; tile++) {
+            const uint32_t lightCount = m_Cursors[tile];
+            m_MaxLightsPerTile = std::max(m_MaxLightsPerTile, lightCount);
+            m_Grid[tile] = offset;
+            m_Cursors[tile] = offset;
+            offset += lightCount;
+        }
+        m_Grid[tileCount] = offset;
+
+        // 第二遍：按光源顺序写入下标，每个瓦片里的光源保持提交顺序
+        for (uint32_t i = 0; i < m_LightCount; i++) {
+            const ScreenLight& screen = m_ScreenLights[i];
+            for (int32_t y = screen.MinY; y <= screen.MaxY; y++) {
+                for (int32_t x = screen.MinX; x <= screen.MaxX; x++) {
+                    if (CoversTile(screen, x, y)) {
+                        m_Grid[m_Cursors[y * m_TilesX + x]++] = i;
+                    }
+                }
+            }
+        }
+    }
+
+    void LightGrid::Upload() {
+        HZ_PROFILE_FUNCTION();
+
+        const uint32_t maxTexels = RenderCaps::Get().MaxTextureBufferSize;
+        const uint32_t lightTexels = (uint32_t)m_LightData.size();
+        if (!m_LightBuffer || lightTexels > m_LightCapacity) {
+            m_LightCapacity = GrowCapacity(lightTexels, maxTexels);
+            m_LightBuffer = TextureBuffer::Create(m_LightCapacity * sizeof(glm::vec4));
+        }
+        const uint32_t gridTexels = (uint32_t)m_Grid.size();
+        if (!m_GridBuffer || gridTexels > m_GridCapacity) {
+            m_GridCapacity = GrowCapacity(gridTexels, maxTexels);
+            m_GridBuffer = TextureBuffer::Create(m_GridCapacity * sizeof(uint32_t), TextureBufferFormat::R32UI);
+        }
+
+        if (lightTexels) {
+            m_LightBuffer->SetData(m_LightData.data(), lightTexels * sizeof(glm::vec4));
+        }
+        m_GridBuffer->SetData(m_Grid.data(), gridTexels * sizeof(uint32_t));
+    }
+
+    void LightGrid::Bind(uint32_t lightsSlot, uint32_t gridSlot) const {
+        HZ_CORE_ASSERT(m_LightBuffer && m_GridBuffer, "LightGrid was not uploaded!");
+
+        m_LightBuffer->Bind(lightsSlot);
+        m_GridBuffer->Bind(gridSlot);
+    }
+}
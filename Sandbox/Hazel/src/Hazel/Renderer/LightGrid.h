@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Core.h"
+#include "Buffer.h"
+#include "OrthographicCamera.h"
+
+namespace Hazel {
+
+    // 2D点光源，亮度从中心按(1 - (d/r)^2)^2衰减到半径处为0
+    struct PointLight
+    {
+        glm::vec2 Position = glm::vec2(0.0f);
+        float Radius = 1.0f; // 世界单位
+        glm::vec3 Color = glm::vec3(1.0f);
+        float Intensity = 1.0f;
+    };
+
+    // 屏幕空间分块的2D光照：屏幕按TileSize像素分成瓦片，CPU上把每个光源分到它覆盖的瓦片里
+    // 片元着色器只计算自己所在瓦片里的光源，开销和每个瓦片的光源数成正比，和光源总数无关
+    // 瓦片表按CSR布局存进一个R32UI纹理缓冲：前(瓦片数+1)项是每个瓦片光源下标的起始位置，后面是光源下标
+    // 用Renderer2D::SetLightGrid交给带光照的shader变体，每帧光源或相机变化后重新Build
+    class LightGrid {
+    public:
+        explicit LightGrid(uint32_t tileSize = 16);
+
+        // 在BeginScene之前调用：按相机和视口大小（像素）分块并上传
+        void Build(const OrthographicCamera& camera, uint32_t viewportWidth, uint32_t viewportHeight,
+                   const PointLight* lights, uint32_t count);
+        // 只在CPU上分块，不上传，benchmark用它测量分块的开销
+        void Bin(const OrthographicCamera& camera, uint32_t viewportWidth, uint32_t viewportHeight,
+                 const PointLight* lights, uint32_t count);
+        void Upload();
+
+        void Bind(uint32_t lightsSlot, uint32_t gridSlot) const;
+
+        // 没有光照时的颜色，光照和它相加后乘到片元颜色上
+        void SetAmbient(const glm::vec3& ambient) { m_Ambient = ambient; }
+        const glm::vec3& GetAmbient() const { return m_Ambient; }
+
+        uint32_t GetTileSize() const { return m_TileSize; }
+        uint32_t GetTilesX() const { return m_TilesX; }
+        uint32_t GetTilesY() const { return m_TilesY; }
+        uint32_t GetLightCount() const { return m_LightCount; }
+        // 所有瓦片的光源下标总数，以及单个瓦片里最多的光源数
+        uint32_t GetTileEntryCount() const { return m_TileEntryCount; }
+        uint32_t GetMaxLightsPerTile() const { return m_MaxLightsPerTile; }
+        // 纹理缓冲放不下而丢掉的光源
+        uint32_t GetDroppedLights() const { return m_DroppedLights; }
+
+    private:
+        // 光源在屏幕上覆盖的瓦片范围和像素空间的圆，范围为空的光源不参与分块
+        struct ScreenLight
+        {
+            int32_t MinX, MinY, MaxX, MaxY;
+            glm::vec2 Center;
+            float Radius;
+        };
+
+        bool CoversTile(const ScreenLight& light, int32_t x, int32_t y) const;
+
+    private:
+        uint32_t m_TileSize;
+        uint32_t m_TilesX = 0;
+        uint32_t m_TilesY = 0;
+        uint32_t m_LightCount = 0;
+        uint32_t m_TileEntryCount = 0;
+        uint32_t m_MaxLightsPerTile = 0;
+        uint32_t m_DroppedLights = 0;
+        glm::vec3 m_Ambient = glm::vec3(0.1f);
+
+        std::vector<ScreenLight> m_ScreenLights;
+        std::vector<glm::vec4> m_LightData; // 每个光源2个纹素：(位置xy, 半径, 强度) (颜色rgb, 0)
+        std::vector<uint32_t> m_Grid;
+        std::vector<uint32_t> m_Cursors;
+
+        // 容量不够时按2的幂重新创建
+        Ref<TextureBuffer> m_LightBuffer;
+        Ref<TextureBuffer> m_GridBuffer;
+        uint32_t m_LightCapacity = 0; // 纹素
+        uint32_t m_GridCapacity = 0;
+    };
+}
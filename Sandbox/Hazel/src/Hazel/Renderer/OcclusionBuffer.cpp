@@ -0,0 +1,172 @@
+#include "OcclusionBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if HZ_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#include "Debugger/Instrumentor.h"
+
+namespace Hazel {
+
+    static const float EmptyDepth = -std::numeric_limits<float>::max();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Scalar ///////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    // 一行里[0, count)的格子取较大的深度
+    static void WriteRowScalar(float* cells, uint32_t count, float depth) {
+        for (uint32_t i = 0; i < count; i++) {
+            cells[i] = std::max(cells[i], depth);
+        }
+    }
+
+    // 一行里的格子都比depth靠前时返回true
+    static bool TestRowScalar(const float* cells, uint32_t count, float depth) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (cells[i] <= depth) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+#if HZ_SIMD_X86
+    /////////////////////////////////////////////////////////////////////////////
+    // SSE //////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    static void WriteRowSSE(float* cells, uint32_t count, float depth) {
+        const __m128 d = _mm_set1_ps(depth);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(cells + i, _mm_max_ps(_mm_loadu_ps(cells + i), d));
+        }
+        WriteRowScalar(cells + i, count - i, depth);
+    }
+
+    static bool TestRowSSE(const float* cells, uint32_t count, float depth) {
+        const __m128 d = _mm_set1_ps(depth);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            if (_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(cells + i), d))) {
+                return false;
+            }
+        }
+        return TestRowScalar(cells + i, count - i, depth);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // AVX2 /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    HZ_TARGET_AVX2 static void WriteRowAVX2(float* cells, uint32_t count, float depth) {
+        const __m256 d = _mm256_set1_ps(depth);
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_ps(cells + i, _mm256_max_ps(_mm256_loadu_ps(cells + i), d));
+        }
+        WriteRowScalar(cells + i, count - i, depth);
+    }
+
+    HZ_TARGET_AVX2 static bool TestRowAVX2(const float* cells, uint32_t count, float depth) {
+        const __m256 d = _mm256_set1_ps(depth);
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            if (_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(cells + i), d, _CMP_LE_OQ))) {
+                return false;
+            }
+        }
+        return TestRowScalar(cells + i, count - i, depth);
+    }
+#endif
+
+    /////////////////////////////////////////////////////////////////////////////
+    // OcclusionBuffer //////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    static SIMD::Level s_Level = SIMD::GetSupportedLevel();
+
+    OcclusionBuffer::OcclusionBuffer(uint32_t width, uint32_t height)
+        : m_Width(std::max(width, 1u)), m_Height(std::max(height, 1u)), m_Depths((size_t)m_Width * m_Height, EmptyDepth) {
+    }
+
+    void OcclusionBuffer::Clear(const glm::vec2 &viewMin, const glm::vec2 &viewMax) {
+        HZ_PROFILE_FUNCTION();
+
+        m_ViewMin = viewMin;
+        const glm::vec2 extent = {std::max(viewMax.x - viewMin.x, 1e-6f), std::max(viewMax.y - viewMin.y, 1e-6f)};
+        m_CellsPerUnit = {m_Width / extent.x, m_Height / extent.y};
+        if (m_OccluderCount) {
+            std::fill(m_Depths.begin(), m_Depths.end(), EmptyDepth);
+            m_OccluderCount = 0;
+        }
+    }
+
+    void OcclusionBuffer::AddOccluder(const glm::vec2 &min, const glm::vec2 &max, float depth) {
+        // 只写入完全在区域里的格子：第i格覆盖[i, i + 1)，需要i >= 左边界并且i + 1 <= 右边界
+        const int32_t x0 = std::max((int32_t)std::ceil((min.x - m_ViewMin.x) * m_CellsPerUnit.x), 0);
+        const int32_t y0 = std::max((int32_t)std::ceil((min.y - m_ViewMin.y) * m_CellsPerUnit.y), 0);
+        const int32_t x1 = std::min((int32_t)std::floor((max.x - m_ViewMin.x) * m_CellsPerUnit.x), (int32_t)m_Width);
+        const int32_t y1 = std::min((int32_t)std::floor((max.y - m_ViewMin.y) * m_CellsPerUnit.y), (int32_t)m_Height);
+        if (x0 >= x1 || y0 >= y1) {
+            return;
+        }
+
+        for (int32_t y = y0; y < y1; y++) {
+            float* row = m_Depths.data() + (size_t)y * m_Width + x0;
+            switch (s_Level) {
+#if HZ_SIMD_X86
+                case SIMD::Level::AVX2: WriteRowAVX2(row, x1 - x0, depth); break;
+                case SIMD::Level::SSE:  WriteRowSSE(row, x1 - x0, depth); break;
+#endif
+                default: WriteRowScalar(row, x1 - x0, depth); break;
+            }
+        }
+        m_OccluderCount++;
+    }
+
+    bool OcclusionBuffer::IsOccluded(const glm::vec2 &min, const glm::vec2 &max, float depth) const {
+        if (m_OccluderCount == 0) {
+            return false;
+        }
+
+        // 碰到的所有格子，超出可见区域的部分截掉
+        const int32_t x0 = std::max((int32_t)std::floor((min.x - m_ViewMin.x) * m_CellsPerUnit.x), 0);
+        const int32_t y0 = std::max((int32_t)std::floor((min.y - m_ViewMin.y) * m_CellsPerUnit.y), 0);
+        const int32_t x1 = std::min((int32_t)std::floor((max.x - m_ViewMin.x) * m_CellsPerUnit.x), (int32_t)m_Width - 1);
+        const int32_t y1 = std::min((int32_t)std::floor((max.y - m_ViewMin.y) * m_CellsPerUnit.y), (int32_t)m_Height - 1);
+        if (x0 > x1 || y0 > y1) {
+            return false;
+        }
+
+        for (int32_t y = y0; y <= y1; y++) {
+            const float* row = m_Depths.data() + (size_t)y * m_Width + x0;
+            bool covered;
+            switch (s_Level) {
+#if HZ_SIMD_X86
+                case SIMD::Level::AVX2: covered = TestRowAVX2(row, x1 - x0 + 1, depth); break;
+                case SIMD::Level::SSE:  covered = TestRowSSE(row, x1 - x0 + 1, depth); break;
+#endif
+                default: covered = TestRowScalar(row, x1 - x0 + 1, depth); break;
+            }
+            if (!covered) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    SIMD::Level OcclusionBuffer::GetLevel() {
+        return s_Level;
+    }
+
+    void OcclusionBuffer::SetLevel(SIMD::Level level) {
+        SIMD::Level supported = SIMD::GetSupportedLevel();
+        s_Level = (int)level > (int)supported ? supported : level;
+    }
+}
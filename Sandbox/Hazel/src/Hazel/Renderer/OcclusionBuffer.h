@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Core/SIMD.h"
+
+namespace Hazel {
+
+    // 低分辨率的CPU遮挡缓冲，用于Renderer2D的遮挡剔除
+    // 可见区域按世界坐标划分成Width x Height个格子，每格记录完全覆盖它的不透明遮挡物里最靠前（z最大）的深度
+    // 遮挡物只写入被它完全覆盖的格子，测试时检查矩形碰到的所有格子，两边都是保守的，不会剔除实际可见的矩形
+    // 每一行的格子是连续的float，写入和测试都按SIMD一次处理多个格子
+    class OcclusionBuffer {
+    public:
+        OcclusionBuffer(uint32_t width = 256, uint32_t height = 128);
+
+        // 按新的可见区域清空所有格子
+        void Clear(const glm::vec2& viewMin, const glm::vec2& viewMax);
+        // 轴对齐的不透明区域，depth越大越靠前
+        void AddOccluder(const glm::vec2& min, const glm::vec2& max, float depth);
+        // 区域碰到的每个格子都被比depth更靠前的遮挡物覆盖时返回true，可见区域以外的部分不检查
+        bool IsOccluded(const glm::vec2& min, const glm::vec2& max, float depth) const;
+
+        uint32_t GetWidth() const { return m_Width; }
+        uint32_t GetHeight() const { return m_Height; }
+        // 本次Clear之后写入了格子的遮挡物数量
+        uint32_t GetOccluderCount() const { return m_OccluderCount; }
+
+        static SIMD::Level GetLevel();
+        // 默认使用CPU支持的最高级别，超过CPU支持的级别会被截断
+        static void SetLevel(SIMD::Level level);
+
+    private:
+        uint32_t m_Width;
+        uint32_t m_Height;
+        uint32_t m_OccluderCount = 0;
+        glm::vec2 m_ViewMin = glm::vec2(0.0f);
+        glm::vec2 m_CellsPerUnit = glm::vec2(0.0f);
+        std::vector<float> m_Depths; // 按行排列，没有遮挡物的格子为-FLT_MAX
+    };
+}
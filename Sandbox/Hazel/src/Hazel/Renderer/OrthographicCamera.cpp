@@ -2,6 +2,8 @@
 #include "OrthographicCamera.h"
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <limits>
+
 #include "Debugger/Instrumentor.h"
 
 namespace Hazel {
@@ -21,6 +23,18 @@ namespace Hazel {
         m_ViewProjectionMatrix = m_ProjectionMatrix * m_ViewMatrix;
     }
 
+    void OrthographicCamera::GetWorldBounds(glm::vec2 &min, glm::vec2 &max) const {
+        // NDC的四个角反变换回世界空间，取包围盒
+        const glm::mat4 inverseViewProjection = glm::inverse(m_ViewProjectionMatrix);
+        min = glm::vec2(std::numeric_limits<float>::max());
+        max = glm::vec2(-std::numeric_limits<float>::max());
+        for (const glm::vec2& corner : {glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f), glm::vec2(1.0f, 1.0f), glm::vec2(-1.0f, 1.0f)}) {
+            const glm::vec4 world = inverseViewProjection * glm::vec4(corner.x, corner.y, 0.0f, 1.0f);
+            min = glm::min(min, glm::vec2(world.x, world.y) / world.w);
+            max = glm::max(max, glm::vec2(world.x, world.y) / world.w);
+        }
+    }
+
     void OrthographicCamera::RecalculateViewMatrix() {
         HZ_PROFILE_FUNCTION();
         
@@ -25,6 +25,9 @@ namespace Hazel {
         const glm::mat4& GetViewMatrix() const {return m_ViewMatrix;}
         const glm::mat4& GetViewProjectionMatrix() const {return m_ViewProjectionMatrix;}
 
+        // 可见区域在世界空间的包围盒，相机旋转时是旋转后矩形的外接框
+        void GetWorldBounds(glm::vec2& min, glm::vec2& max) const;
+
     private:
         void RecalculateViewMatrix();
     private:
@@ -0,0 +1,289 @@
+#include "ParticleSystem.h"
+
+#include <algorithm>
+
+#if HZ_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#include "Base.h"
+#include "Renderer2D.h"
+#include "Debugger/Instrumentor.h"
+
+namespace Hazel {
+
+    // 更新分两步：Integrate对位置和寿命做逐float的运算，删掉死粒子之后Interpolate按寿命比例插值颜色和尺寸
+    // 位置和速度都是交错的(x, y)，逐float运算不需要区分分量
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Scalar ///////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    static void IntegrateScalar(float* positions, const float* velocities, float* life, uint32_t count, float dt) {
+        for (uint32_t i = 0; i < count * 2; i++) {
+            positions[i] += velocities[i] * dt;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            life[i] -= dt;
+        }
+    }
+
+    static void InterpolateScalar(const float* life, const float* inverseLifeTimes, const float* colorBegins, const float* colorEnds,
+                                  const float* sizeBegins, const float* sizeEnds, float* colors, float* sizes,
+                                  uint32_t count, uint32_t begin = 0) {
+        for (uint32_t i = begin; i < count; i++) {
+            const float t = 1.0f - life[i] * inverseLifeTimes[i];
+            for (uint32_t j = i * 4; j < i * 4 + 4; j++) {
+                colors[j] = colorBegins[j] + (colorEnds[j] - colorBegins[j]) * t;
+            }
+            const float size = sizeBegins[i] + (sizeEnds[i] - sizeBegins[i]) * t;
+            sizes[i * 2] = size;
+            sizes[i * 2 + 1] = size;
+        }
+    }
+
+#if HZ_SIMD_X86
+    /////////////////////////////////////////////////////////////////////////////
+    // SSE //////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    static void IntegrateSSE(float* positions, const float* velocities, float* life, uint32_t count, float dt) {
+        const __m128 step = _mm_set1_ps(dt);
+        // 4个float是2个粒子的位置
+        uint32_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            __m128 p = _mm_loadu_ps(positions + i * 2);
+            p = _mm_add_ps(p, _mm_mul_ps(_mm_loadu_ps(velocities + i * 2), step));
+            _mm_storeu_ps(positions + i * 2, p);
+        }
+        uint32_t j = 0;
+        for (; j + 4 <= count; j += 4) {
+            _mm_storeu_ps(life + j, _mm_sub_ps(_mm_loadu_ps(life + j), step));
+        }
+        for (; i < count; i++) {
+            positions[i * 2] += velocities[i * 2] * dt;
+            positions[i * 2 + 1] += velocities[i * 2 + 1] * dt;
+        }
+        for (; j < count; j++) {
+            life[j] -= dt;
+        }
+    }
+
+    static inline void LerpColorSSE(const float* begin, const float* end, __m128 t, float* out) {
+        const __m128 b = _mm_loadu_ps(begin);
+        _mm_storeu_ps(out, _mm_add_ps(b, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(end), b), t)));
+    }
+
+    static void InterpolateSSE(const float* life, const float* inverseLifeTimes, const float* colorBegins, const float* colorEnds,
+                               const float* sizeBegins, const float* sizeEnds, float* colors, float* sizes, uint32_t count) {
+        const __m128 one = _mm_set1_ps(1.0f);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128 t = _mm_sub_ps(one, _mm_mul_ps(_mm_loadu_ps(life + i), _mm_loadu_ps(inverseLifeTimes + i)));
+
+            const __m128 sizeBegin = _mm_loadu_ps(sizeBegins + i);
+            const __m128 size = _mm_add_ps(sizeBegin, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(sizeEnds + i), sizeBegin), t));
+            // 尺寸展开成(s, s)
+            _mm_storeu_ps(sizes + i * 2, _mm_unpacklo_ps(size, size));
+            _mm_storeu_ps(sizes + i * 2 + 4, _mm_unpackhi_ps(size, size));
+
+            // 每个粒子的颜色正好是一个__m128，t广播到4个分量
+            LerpColorSSE(colorBegins + i * 4, colorEnds + i * 4, _mm_shuffle_ps(t, t, 0x00), colors + i * 4);
+            LerpColorSSE(colorBegins + i * 4 + 4, colorEnds + i * 4 + 4, _mm_shuffle_ps(t, t, 0x55), colors + i * 4 + 4);
+            LerpColorSSE(colorBegins + i * 4 + 8, colorEnds + i * 4 + 8, _mm_shuffle_ps(t, t, 0xaa), colors + i * 4 + 8);
+            LerpColorSSE(colorBegins + i * 4 + 12, colorEnds + i * 4 + 12, _mm_shuffle_ps(t, t, 0xff), colors + i * 4 + 12);
+        }
+        InterpolateScalar(life, inverseLifeTimes, colorBegins, colorEnds, sizeBegins, sizeEnds, colors, sizes, count, i);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // AVX2 /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    HZ_TARGET_AVX2 static void IntegrateAVX2(float* positions, const float* velocities, float* life, uint32_t count, float dt) {
+        const __m256 step = _mm256_set1_ps(dt);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m256 p = _mm256_loadu_ps(positions + i * 2);
+            p = _mm256_add_ps(p, _mm256_mul_ps(_mm256_loadu_ps(velocities + i * 2), step));
+            _mm256_storeu_ps(positions + i * 2, p);
+        }
+        uint32_t j = 0;
+        for (; j + 8 <= count; j += 8) {
+            _mm256_storeu_ps(life + j, _mm256_sub_ps(_mm256_loadu_ps(life + j), step));
+        }
+        for (; i < count; i++) {
+            positions[i * 2] += velocities[i * 2] * dt;
+            positions[i * 2 + 1] += velocities[i * 2 + 1] * dt;
+        }
+        for (; j < count; j++) {
+            life[j] -= dt;
+        }
+    }
+
+    // 两个粒子的颜色放在一个__m256里，tPair的低/高128位分别是它们的t
+    HZ_TARGET_AVX2 static inline void LerpColorPairAVX2(const float* begin, const float* end, __m256 tPair, float* out) {
+        const __m256 b = _mm256_loadu_ps(begin);
+        _mm256_storeu_ps(out, _mm256_add_ps(b, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(end), b), tPair)));
+    }
+
+    HZ_TARGET_AVX2 static void InterpolateAVX2(const float* life, const float* inverseLifeTimes, const float* colorBegins, const float* colorEnds,
+                                               const float* sizeBegins, const float* sizeEnds, float* colors, float* sizes, uint32_t count) {
+        const __m256 one = _mm256_set1_ps(1.0f);
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m256 t = _mm256_sub_ps(one, _mm256_mul_ps(_mm256_loadu_ps(life + i), _mm256_loadu_ps(inverseLifeTimes + i)));
+
+            const __m256 sizeBegin = _mm256_loadu_ps(sizeBegins + i);
+            const __m256 size = _mm256_add_ps(sizeBegin, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(sizeEnds + i), sizeBegin), t));
+            // unpack在每个128位内进行：lo = [s0 s0 s1 s1 | s4 s4 s5 s5]，hi = [s2 s2 s3 s3 | s6 s6 s7 s7]
+            const __m256 lo = _mm256_unpacklo_ps(size, size);
+            const __m256 hi = _mm256_unpackhi_ps(size, size);
+            _mm256_storeu_ps(sizes + i * 2, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(sizes + i * 2 + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+
+            for (int k = 0; k < 8; k += 2) {
+                const __m256 tPair = _mm256_permutevar8x32_ps(t, _mm256_setr_epi32(k, k, k, k, k + 1, k + 1, k + 1, k + 1));
+                LerpColorPairAVX2(colorBegins + (i + k) * 4, colorEnds + (i + k) * 4, tPair, colors + (i + k) * 4);
+            }
+        }
+        InterpolateScalar(life, inverseLifeTimes, colorBegins, colorEnds, sizeBegins, sizeEnds, colors, sizes, count, i);
+    }
+#endif
+
+    /////////////////////////////////////////////////////////////////////////////
+    // ParticleSystem ///////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    static SIMD::Level s_Level = SIMD::GetSupportedLevel();
+
+    ParticleSystem::ParticleSystem(uint32_t capacity) : m_Capacity(capacity), m_Random(std::random_device()()) {
+        HZ_PROFILE_FUNCTION();
+
+        m_Velocities.resize(capacity);
+        m_ColorBegins.resize(capacity);
+        m_ColorEnds.resize(capacity);
+        m_SizeBegins.resize(capacity);
+        m_SizeEnds.resize(capacity);
+        m_LifeRemaining.resize(capacity);
+        m_InverseLifeTimes.resize(capacity);
+        m_Positions.resize(capacity);
+        m_Sizes.resize(capacity);
+        m_Colors.resize(capacity);
+    }
+
+    void ParticleSystem::Emit(const ParticleProps &props, uint32_t count) {
+        HZ_PROFILE_FUNCTION();
+
+        HZ_CORE_ASSERT(props.LifeTime > 0.0f, "Particle lifetime must be positive!");
+
+        std::uniform_real_distribution<float> variation(-0.5f, 0.5f);
+        const uint32_t emitted = std::min(count, m_Capacity - m_Count);
+        for (uint32_t n = 0; n < emitted; n++) {
+            const uint32_t i = m_Count++;
+            const float sizeBegin = std::max(props.SizeBegin + props.SizeVariation * variation(m_Random), 0.0f);
+
+            m_Positions[i] = props.Position;
+            m_Velocities[i] = {props.Velocity.x + props.VelocityVariation.x * variation(m_Random),
+                               props.Velocity.y + props.VelocityVariation.y * variation(m_Random)};
+            m_ColorBegins[i] = props.ColorBegin;
+            m_ColorEnds[i] = props.ColorEnd;
+            m_SizeBegins[i] = sizeBegin;
+            m_SizeEnds[i] = props.SizeEnd;
+            m_LifeRemaining[i] = props.LifeTime;
+            m_InverseLifeTimes[i] = 1.0f / props.LifeTime;
+            // 发射的这一帧就能绘制
+            m_Colors[i] = props.ColorBegin;
+            m_Sizes[i] = {sizeBegin, sizeBegin};
+        }
+    }
+
+    void ParticleSystem::RemoveDead() {
+        // 死粒子和最后一个交换，换过来的粒子还要再检查一次，所以不前进
+        for (uint32_t i = 0; i < m_Count;) {
+            if (m_LifeRemaining[i] > 0.0f) {
+                i++;
+                continue;
+            }
+            const uint32_t last = --m_Count;
+            if (i == last) {
+                break;
+            }
+            m_Positions[i] = m_Positions[last];
+            m_Velocities[i] = m_Velocities[last];
+            m_ColorBegins[i] = m_ColorBegins[last];
+            m_ColorEnds[i] = m_ColorEnds[last];
+            m_SizeBegins[i] = m_SizeBegins[last];
+            m_SizeEnds[i] = m_SizeEnds[last];
+            m_LifeRemaining[i] = m_LifeRemaining[last];
+            m_InverseLifeTimes[i] = m_InverseLifeTimes[last];
+        }
+    }
+
+    void ParticleSystem::OnUpdate(Timestep ts) {
+        HZ_PROFILE_FUNCTION();
+
+        if (m_Count == 0) {
+            return;
+        }
+
+        const float dt = ts;
+        float* positions = &m_Positions[0].x;
+        const float* velocities = &m_Velocities[0].x;
+        switch (s_Level) {
+#if HZ_SIMD_X86
+            case SIMD::Level::AVX2: IntegrateAVX2(positions, velocities, m_LifeRemaining.data(), m_Count, dt); break;
+            case SIMD::Level::SSE:  IntegrateSSE(positions, velocities, m_LifeRemaining.data(), m_Count, dt); break;
+#endif
+            default: IntegrateScalar(positions, velocities, m_LifeRemaining.data(), m_Count, dt); break;
+        }
+
+        RemoveDead();
+
+        const float* colorBegins = &m_ColorBegins[0].x;
+        const float* colorEnds = &m_ColorEnds[0].x;
+        float* colors = &m_Colors[0].x;
+        float* sizes = &m_Sizes[0].x;
+        switch (s_Level) {
+#if HZ_SIMD_X86
+            case SIMD::Level::AVX2:
+                InterpolateAVX2(m_LifeRemaining.data(), m_InverseLifeTimes.data(), colorBegins, colorEnds,
+                                m_SizeBegins.data(), m_SizeEnds.data(), colors, sizes, m_Count);
+                break;
+            case SIMD::Level::SSE:
+                InterpolateSSE(m_LifeRemaining.data(), m_InverseLifeTimes.data(), colorBegins, colorEnds,
+                               m_SizeBegins.data(), m_SizeEnds.data(), colors, sizes, m_Count);
+                break;
+#endif
+            default:
+                InterpolateScalar(m_LifeRemaining.data(), m_InverseLifeTimes.data(), colorBegins, colorEnds,
+                                  m_SizeBegins.data(), m_SizeEnds.data(), colors, sizes, m_Count);
+                break;
+        }
+    }
+
+    void ParticleSystem::OnRender(float depth) const {
+        HZ_PROFILE_FUNCTION();
+
+        if (m_Count == 0) {
+            return;
+        }
+
+        Renderer2D::QuadBatch batch;
+        batch.Count = m_Count;
+        batch.Positions = m_Positions.data();
+        batch.Sizes = m_Sizes.data();
+        batch.Colors = m_Colors.data();
+        batch.Depth = depth;
+        Renderer2D::DrawQuads(batch);
+    }
+
+    SIMD::Level ParticleSystem::GetLevel() {
+        return s_Level;
+    }
+
+    void ParticleSystem::SetLevel(SIMD::Level level) {
+        SIMD::Level supported = SIMD::GetSupportedLevel();
+        s_Level = (int)level > (int)supported ? supported : level;
+    }
+}
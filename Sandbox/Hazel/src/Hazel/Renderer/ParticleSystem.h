@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Timestep.h"
+#include "Core/SIMD.h"
+
+namespace Hazel {
+
+    // 一次发射的参数，Variation为在基础值上随机浮动的范围
+    struct ParticleProps
+    {
+        glm::vec2 Position = glm::vec2(0.0f);
+        glm::vec2 Velocity = glm::vec2(0.0f);
+        glm::vec2 VelocityVariation = glm::vec2(0.0f);
+        glm::vec4 ColorBegin = glm::vec4(1.0f);
+        glm::vec4 ColorEnd = glm::vec4(1.0f);
+        float SizeBegin = 1.0f;
+        float SizeEnd = 0.0f;
+        float SizeVariation = 0.0f;
+        float LifeTime = 1.0f; // 秒
+    };
+
+    // 固定容量的粒子池，数据按SoA布局存放：更新时每个属性是一段连续的float，用SIMD一次处理多个粒子
+    // 死掉的粒子和最后一个交换后删除，存活的粒子始终是[0, count)，渲染时整段交给Renderer2D::DrawQuads
+    // 池满时新发射的粒子被丢弃
+    class ParticleSystem {
+    public:
+        explicit ParticleSystem(uint32_t capacity = 100000);
+
+        void Emit(const ParticleProps& props, uint32_t count = 1);
+        void OnUpdate(Timestep ts);
+        // 在BeginScene/EndScene之间调用，按当前的渲染模式走批次或者实例化路径
+        void OnRender(float depth = 0.0f) const;
+        void Clear() { m_Count = 0; }
+
+        uint32_t GetCount() const { return m_Count; }
+        uint32_t GetCapacity() const { return m_Capacity; }
+
+        static SIMD::Level GetLevel();
+        // 默认使用CPU支持的最高级别，主要给benchmark对比不同实现用，超过CPU支持的级别会被截断
+        static void SetLevel(SIMD::Level level);
+
+    private:
+        void RemoveDead();
+
+    private:
+        uint32_t m_Capacity;
+        uint32_t m_Count = 0;
+
+        // 模拟数据
+        std::vector<glm::vec2> m_Velocities;
+        std::vector<glm::vec4> m_ColorBegins;
+        std::vector<glm::vec4> m_ColorEnds;
+        std::vector<float> m_SizeBegins;
+        std::vector<float> m_SizeEnds;
+        std::vector<float> m_LifeRemaining;
+        std::vector<float> m_InverseLifeTimes;
+
+        // 模拟数据，同时也是DrawQuads的输入
+        std::vector<glm::vec2> m_Positions;
+        std::vector<glm::vec2> m_Sizes;
+        std::vector<glm::vec4> m_Colors;
+
+        std::mt19937 m_Random;
+    };
+}
@@ -0,0 +1,187 @@
+#include "QuadKernel.h"
+
+#include <cmath>
+
+#if HZ_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#include "Debugger/Instrumentor.h"
+
+namespace Hazel {
+
+    // 单位矩形四个顶点的x/y符号，乘上半尺寸即为局部坐标
+    static constexpr float s_CornerX[4] = {-1.0f, 1.0f, 1.0f, -1.0f};
+    static constexpr float s_CornerY[4] = {-1.0f, -1.0f, 1.0f, 1.0f};
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Scalar ///////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    // 旋转后的两个半轴 a = (hx*c, hx*s)，b = (-hy*s, hy*c)，顶点 = p + lx*a + ly*b
+    static inline void CornersScalar(float px, float py, float hx, float hy, float c, float s, float* xs, float* ys) {
+        const float ax = hx * c, ay = hx * s;
+        const float bx = -hy * s, by = hy * c;
+        for (int i = 0; i < 4; i++) {
+            xs[i] = px + s_CornerX[i] * ax + s_CornerY[i] * bx;
+            ys[i] = py + s_CornerX[i] * ay + s_CornerY[i] * by;
+        }
+    }
+
+    static inline void CornersAxisAlignedScalar(float px, float py, float hx, float hy, float* xs, float* ys) {
+        xs[0] = px - hx; ys[0] = py - hy;
+        xs[1] = px + hx; ys[1] = py - hy;
+        xs[2] = px + hx; ys[2] = py + hy;
+        xs[3] = px - hx; ys[3] = py + hy;
+    }
+
+    static void BatchScalar(const glm::vec2* positions, const glm::vec2* sizes, const float* rotations,
+                            uint32_t count, float* xs, float* ys) {
+        if (rotations) {
+            for (uint32_t i = 0; i < count; i++) {
+                CornersScalar(positions[i].x, positions[i].y, sizes[i].x * 0.5f, sizes[i].y * 0.5f,
+                              std::cos(rotations[i]), std::sin(rotations[i]), xs + i * 4, ys + i * 4);
+            }
+        } else {
+            for (uint32_t i = 0; i < count; i++) {
+                CornersAxisAlignedScalar(positions[i].x, positions[i].y, sizes[i].x * 0.5f, sizes[i].y * 0.5f,
+                                         xs + i * 4, ys + i * 4);
+            }
+        }
+    }
+
+#if HZ_SIMD_X86
+    /////////////////////////////////////////////////////////////////////////////
+    // SSE //////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    // 一个__m128正好放下一个矩形的4个顶点
+    static inline void CornersSSE(float px, float py, float hx, float hy, float c, float s, float* xs, float* ys) {
+        const __m128 lx = _mm_loadu_ps(s_CornerX);
+        const __m128 ly = _mm_loadu_ps(s_CornerY);
+        __m128 x = _mm_add_ps(_mm_set1_ps(px), _mm_add_ps(_mm_mul_ps(lx, _mm_set1_ps(hx * c)), _mm_mul_ps(ly, _mm_set1_ps(-hy * s))));
+        __m128 y = _mm_add_ps(_mm_set1_ps(py), _mm_add_ps(_mm_mul_ps(lx, _mm_set1_ps(hx * s)), _mm_mul_ps(ly, _mm_set1_ps(hy * c))));
+        _mm_storeu_ps(xs, x);
+        _mm_storeu_ps(ys, y);
+    }
+
+    static inline void CornersAxisAlignedSSE(float px, float py, float hx, float hy, float* xs, float* ys) {
+        const __m128 lx = _mm_loadu_ps(s_CornerX);
+        const __m128 ly = _mm_loadu_ps(s_CornerY);
+        _mm_storeu_ps(xs, _mm_add_ps(_mm_set1_ps(px), _mm_mul_ps(lx, _mm_set1_ps(hx))));
+        _mm_storeu_ps(ys, _mm_add_ps(_mm_set1_ps(py), _mm_mul_ps(ly, _mm_set1_ps(hy))));
+    }
+
+    static void BatchSSE(const glm::vec2* positions, const glm::vec2* sizes, const float* rotations,
+                         uint32_t count, float* xs, float* ys) {
+        if (rotations) {
+            for (uint32_t i = 0; i < count; i++) {
+                CornersSSE(positions[i].x, positions[i].y, sizes[i].x * 0.5f, sizes[i].y * 0.5f,
+                           std::cos(rotations[i]), std::sin(rotations[i]), xs + i * 4, ys + i * 4);
+            }
+        } else {
+            for (uint32_t i = 0; i < count; i++) {
+                CornersAxisAlignedSSE(positions[i].x, positions[i].y, sizes[i].x * 0.5f, sizes[i].y * 0.5f,
+                                      xs + i * 4, ys + i * 4);
+            }
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // AVX2 /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    // 低128位放第i个矩形，高128位放第i+1个矩形
+    HZ_TARGET_AVX2 static inline __m256 Pair(float lo, float hi) {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(lo)), _mm_set1_ps(hi), 1);
+    }
+
+    HZ_TARGET_AVX2 static void BatchAVX2(const glm::vec2* positions, const glm::vec2* sizes, const float* rotations,
+                                         uint32_t count, float* xs, float* ys) {
+        const __m256 lx = _mm256_setr_ps(-1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f);
+        const __m256 ly = _mm256_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f);
+
+        uint32_t i = 0;
+        if (rotations) {
+            for (; i + 1 < count; i += 2) {
+                const float hx0 = sizes[i].x * 0.5f, hy0 = sizes[i].y * 0.5f;
+                const float hx1 = sizes[i + 1].x * 0.5f, hy1 = sizes[i + 1].y * 0.5f;
+                const float c0 = std::cos(rotations[i]), s0 = std::sin(rotations[i]);
+                const float c1 = std::cos(rotations[i + 1]), s1 = std::sin(rotations[i + 1]);
+
+                __m256 x = _mm256_add_ps(Pair(positions[i].x, positions[i + 1].x),
+                                         _mm256_add_ps(_mm256_mul_ps(lx, Pair(hx0 * c0, hx1 * c1)),
+                                                       _mm256_mul_ps(ly, Pair(-hy0 * s0, -hy1 * s1))));
+                __m256 y = _mm256_add_ps(Pair(positions[i].y, positions[i + 1].y),
+                                         _mm256_add_ps(_mm256_mul_ps(lx, Pair(hx0 * s0, hx1 * s1)),
+                                                       _mm256_mul_ps(ly, Pair(hy0 * c0, hy1 * c1))));
+                _mm256_storeu_ps(xs + i * 4, x);
+                _mm256_storeu_ps(ys + i * 4, y);
+            }
+        } else {
+            for (; i + 1 < count; i += 2) {
+                __m256 x = _mm256_add_ps(Pair(positions[i].x, positions[i + 1].x),
+                                         _mm256_mul_ps(lx, Pair(sizes[i].x * 0.5f, sizes[i + 1].x * 0.5f)));
+                __m256 y = _mm256_add_ps(Pair(positions[i].y, positions[i + 1].y),
+                                         _mm256_mul_ps(ly, Pair(sizes[i].y * 0.5f, sizes[i + 1].y * 0.5f)));
+                _mm256_storeu_ps(xs + i * 4, x);
+                _mm256_storeu_ps(ys + i * 4, y);
+            }
+        }
+
+        // 奇数个时剩下的一个走SSE
+        if (i < count) {
+            BatchSSE(positions + i, sizes + i, rotations ? rotations + i : nullptr, count - i, xs + i * 4, ys + i * 4);
+        }
+    }
+#endif
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Dispatch /////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    static SIMD::Level s_Level = SIMD::GetSupportedLevel();
+
+    void QuadKernel::GenerateCorners(const glm::vec2 &position, const glm::vec2 &size, float rotation, float *xs, float *ys) {
+        const float c = std::cos(rotation), s = std::sin(rotation);
+#if HZ_SIMD_X86
+        if (s_Level != SIMD::Level::Scalar) {
+            CornersSSE(position.x, position.y, size.x * 0.5f, size.y * 0.5f, c, s, xs, ys);
+            return;
+        }
+#endif
+        CornersScalar(position.x, position.y, size.x * 0.5f, size.y * 0.5f, c, s, xs, ys);
+    }
+
+    void QuadKernel::GenerateCornersAxisAligned(const glm::vec2 &position, const glm::vec2 &size, float *xs, float *ys) {
+#if HZ_SIMD_X86
+        if (s_Level != SIMD::Level::Scalar) {
+            CornersAxisAlignedSSE(position.x, position.y, size.x * 0.5f, size.y * 0.5f, xs, ys);
+            return;
+        }
+#endif
+        CornersAxisAlignedScalar(position.x, position.y, size.x * 0.5f, size.y * 0.5f, xs, ys);
+    }
+
+    void QuadKernel::GenerateCorners(const glm::vec2 *positions, const glm::vec2 *sizes, const float *rotations,
+                                     uint32_t count, float *xs, float *ys) {
+        HZ_PROFILE_FUNCTION();
+
+        switch (s_Level) {
+#if HZ_SIMD_X86
+            case SIMD::Level::AVX2: BatchAVX2(positions, sizes, rotations, count, xs, ys); return;
+            case SIMD::Level::SSE:  BatchSSE(positions, sizes, rotations, count, xs, ys); return;
+#endif
+            default: BatchScalar(positions, sizes, rotations, count, xs, ys); return;
+        }
+    }
+
+    SIMD::Level QuadKernel::GetLevel() {
+        return s_Level;
+    }
+
+    void QuadKernel::SetLevel(SIMD::Level level) {
+        SIMD::Level supported = SIMD::GetSupportedLevel();
+        s_Level = (int)level > (int)supported ? supported : level;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "Core/SIMD.h"
+
+namespace Hazel {
+    // 矩形顶点生成内核
+    // 直接由位置/尺寸/旋转计算矩形的四个顶点，不再构建translate*rotate*scale的mat4再做4次矩阵乘法
+    // 顶点顺序与Renderer2D一致：左下、右下、右上、左上
+    class QuadKernel {
+    public:
+        // 单个矩形，rotation为弧度
+        static void GenerateCorners(const glm::vec2& position, const glm::vec2& size, float rotation, float* xs, float* ys);
+        // 未旋转的矩形，只需要加减半尺寸
+        static void GenerateCornersAxisAligned(const glm::vec2& position, const glm::vec2& size, float* xs, float* ys);
+
+        // 批量生成count个矩形的顶点，xs/ys各输出4*count个值
+        // rotations为nullptr时全部按未旋转处理
+        static void GenerateCorners(const glm::vec2* positions, const glm::vec2* sizes, const float* rotations,
+                                    uint32_t count, float* xs, float* ys);
+
+        static SIMD::Level GetLevel();
+        // 默认使用CPU支持的最高级别，主要给benchmark对比不同实现用，超过CPU支持的级别会被截断
+        static void SetLevel(SIMD::Level level);
+    };
+}
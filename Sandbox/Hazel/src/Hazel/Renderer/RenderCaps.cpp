@@ -0,0 +1,15 @@
+#include "RenderCaps.h"
+
+#include <algorithm>
+
+namespace Hazel {
+
+    bool RenderCaps::HasExtension(const std::string &name) const {
+        return std::find(Extensions.begin(), Extensions.end(), name) != Extensions.end();
+    }
+
+    RenderCaps& RenderCaps::Get() {
+        static RenderCaps s_Caps;
+        return s_Caps;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Hazel {
+
+    // 图形后端在创建上下文时查询到的能力和限制，Renderer2D等按这些值决定批次大小、纹理槽数量和shader变体
+    struct RenderCaps
+    {
+        std::string Vendor;
+        std::string Renderer;
+        std::string Version;
+        int VersionMajor = 0;
+        int VersionMinor = 0;
+
+        uint32_t MaxTextureSlots = 16;          // 片元着色器可用的纹理单元，GL_MAX_TEXTURE_IMAGE_UNITS
+        uint32_t MaxCombinedTextureSlots = 16;  // 所有阶段合计
+        uint32_t MaxTextureSize = 2048;
+        uint32_t MaxArrayTextureLayers = 256;
+        uint32_t MaxUniformBlockSize = 16384;
+        uint32_t MaxVertexAttribs = 16;
+        uint32_t MaxTextureBufferSize = 65536;  // 纹理缓冲最多的纹素数，GL_MAX_TEXTURE_BUFFER_SIZE
+        // 驱动建议的单次绘制最大顶点/索引数，只是性能提示
+        uint32_t MaxElementsVertices = 0;
+        uint32_t MaxElementsIndices = 0;
+
+        bool BufferStorage = false;          // GL_ARB_buffer_storage / 4.4，持久映射
+        bool MultiDrawIndirect = false;      // GL_ARB_multi_draw_indirect / 4.3
+        bool ParallelShaderCompile = false;  // GL_KHR_parallel_shader_compile / GL_ARB_parallel_shader_compile
+
+        std::vector<std::string> Extensions;
+
+        bool HasExtension(const std::string& name) const;
+        bool IsVersionAtLeast(int major, int minor) const {
+            return VersionMajor > major || (VersionMajor == major && VersionMinor >= minor);
+        }
+
+        // 由GraphicsContext::Init填充，之前读取到的是保守的默认值
+        static RenderCaps& Get();
+    };
+}
@@ -28,6 +28,22 @@ namespace Hazel {
             s_RendererAPI->DrawIndexed(vertexArray, count);
         }
 
+        static inline void DrawIndexedInstanced(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t instanceCount) {
+            s_RendererAPI->DrawIndexedInstanced(vertexArray, indexCount, instanceCount);
+        }
+
+        static inline void DrawIndexedBaseVertex(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t baseVertex) {
+            s_RendererAPI->DrawIndexedBaseVertex(vertexArray, indexCount, baseVertex);
+        }
+
+        static inline void DrawArrays(const Ref<VertexArray>& vertexArray, uint32_t vertexCount) {
+            s_RendererAPI->DrawArrays(vertexArray, vertexCount);
+        }
+
+        static inline void SetDepthWrite(bool enabled) {
+            s_RendererAPI->SetDepthWrite(enabled);
+        }
+
     private:
         static RendererAPI* s_RendererAPI;
     };
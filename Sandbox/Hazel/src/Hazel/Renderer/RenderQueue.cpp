@@ -0,0 +1,60 @@
+#include "RenderQueue.h"
+
+#include <cstring>
+#include <utility>
+
+#include "Debugger/Instrumentor.h"
+
+namespace Hazel {
+
+    void RenderQueue::Sort() {
+        HZ_PROFILE_FUNCTION();
+
+        const size_t count = m_Entries.size();
+        if (count < 2) {
+            return;
+        }
+        m_Scratch.resize(count);
+
+        // 一次遍历统计8个字节各自的直方图
+        uint32_t histograms[8][256];
+        memset(histograms, 0, sizeof(histograms));
+        for (const Entry& entry : m_Entries) {
+            for (int pass = 0; pass < 8; pass++) {
+                histograms[pass][(entry.Key >> (pass * 8)) & 0xff]++;
+            }
+        }
+
+        Entry* src = m_Entries.data();
+        Entry* dst = m_Scratch.data();
+        for (int pass = 0; pass < 8; pass++) {
+            uint32_t* histogram = histograms[pass];
+            // 这个字节所有键都相同（比如没用到的层和纹理位），排序不会改变顺序，跳过
+            if (histogram[(src[0].Key >> (pass * 8)) & 0xff] == count) {
+                continue;
+            }
+
+            uint32_t offset = 0;
+            for (uint32_t bucket = 0; bucket < 256; bucket++) {
+                uint32_t size = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += size;
+            }
+            for (size_t i = 0; i < count; i++) {
+                dst[histogram[(src[i].Key >> (pass * 8)) & 0xff]++] = src[i];
+            }
+            std::swap(src, dst);
+        }
+
+        if (src != m_Entries.data()) {
+            m_Entries.swap(m_Scratch);
+        }
+    }
+
+    uint32_t RenderQueue::OrderedBits(float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        // 正数翻转符号位，负数翻转所有位，这样按无符号比较和按浮点比较结果一致
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Hazel {
+
+    // 按64位排序键排序的命令队列，只保存键和命令下标，命令本身由使用者保存
+    // 排序是稳定的基数排序，键相同的命令保持提交顺序
+    class RenderQueue {
+    public:
+        struct Entry
+        {
+            uint64_t Key;
+            uint32_t Index;
+        };
+
+        void Clear() { m_Entries.clear(); }
+        void Push(uint64_t key, uint32_t index) { m_Entries.push_back({key, index}); }
+        void Sort();
+
+        const std::vector<Entry>& GetEntries() const { return m_Entries; }
+        uint32_t GetSize() const { return (uint32_t)m_Entries.size(); }
+        bool IsEmpty() const { return m_Entries.empty(); }
+
+        // 把浮点数映射成保持大小顺序的无符号整数，用于把深度放进排序键
+        static uint32_t OrderedBits(float value);
+
+    private:
+        std::vector<Entry> m_Entries;
+        std::vector<Entry> m_Scratch;
+    };
+}
@@ -1,11 +1,30 @@
 #include "Renderer2D.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 
+#include "Buffer.h"
 #include "VertexArray.h"
+#include "QuadKernel.h"
 #include "Shader.h"
 #include "Platform/OpenGL/OpenGLShader.h"
 #include "RenderCommand.h"
+#include "RenderCaps.h"
+#include "RenderQueue.h"
+#include "Tilemap.h"
+#include "Triangulator.h"
+#include "SpriteCuller.h"
+#include "OcclusionBuffer.h"
+#include "Log.h"
 #include "Debugger/Instrumentor.h"
 namespace Hazel {
     struct QuadVertex
@@ -17,55 +36,270 @@ namespace Hazel {
         float TilingFactor;
     };
 
+    // 压缩顶点，20字节：位置保留float精度，深度和纹理索引、乘过tiling的纹理坐标用半精度，颜色用8位归一化
+    struct PackedQuadVertex
+    {
+        glm::vec2 Position;
+        uint32_t DepthTexIndex; // half2(z, texIndex)
+        uint32_t TexCoord;      // half2(uv * tilingFactor)
+        uint32_t Color;         // unorm4x8
+    };
+
+    // 实例化模式下每个矩形只上传一条记录，四个顶点由vertex shader展开
+    // 每条记录64字节，批处理模式下4个顶点是160字节，上传量约为批处理模式的2/5
+    struct QuadInstance
+    {
+        glm::vec3 Position;
+        glm::vec2 Size;
+        float Rotation; // 弧度
+        glm::vec4 Color;
+        glm::vec4 TexRect; // 左下角uv, 右上角uv
+        float TexIndex;
+        float TilingFactor;
+    };
+    // 顶点拉取时同样的记录按4个RGBA32F纹素读取，shader里的解码依赖这个布局
+    static_assert(sizeof(QuadInstance) == 64, "QuadInstance must be 4 vec4 texels");
+
+    // 纯色矩形的纹理索引，shader里不采样，纹理槽和纹理数组两种批次都可以用
+    static const float NoTextureIndex = -1.0f;
+    // 距离场纹理的索引加上这个偏移，shader里按距离场采样；比纹理槽上限大，和shader里的HZ_DISTANCE_FIELD_OFFSET一致
+    static const float DistanceFieldTexIndexOffset = 64.0f;
+    // 形状的纹理索引：(-2.5, -2]为直角矩形，(-3.5, -3]为圆角矩形，小数部分乘2是描边宽度占最短半边的比例
+    // 形状都是纯色，可以放进任何批次；和shader里的SetShape一致
+    static const float BoxShapeTexIndex = -2.0f;
+    static const float RoundedShapeTexIndex = -3.0f;
+
+    // 排序提交时记录的矩形，纹理保存为本帧纹理表里的下标
+    enum class QueuedTextureKind : uint8_t
+    {
+        None = 0, Slot = 1, Array = 2, DistanceField = 3, // DistanceField也占用纹理槽，只是按距离场采样
+        Shape = 4 // 不用纹理，纹理索引是形状的编码
+    };
+
+    static bool UsesTextureSlot(QueuedTextureKind kind) {
+        return kind == QueuedTextureKind::Slot || kind == QueuedTextureKind::DistanceField;
+    }
+
+    static float GetSlotTexIndex(QueuedTextureKind kind, float slot) {
+        return kind == QueuedTextureKind::DistanceField ? slot + DistanceFieldTexIndexOffset : slot;
+    }
+
+    struct QueuedQuad
+    {
+        glm::vec3 Position;
+        glm::vec2 Size;
+        float Rotation; // 弧度
+        glm::vec4 Color;
+        glm::vec2 UVMin;
+        glm::vec2 UVMax;
+        float TilingFactor;
+        uint32_t Texture;
+        uint32_t ArrayLayer;
+        QueuedTextureKind Kind;
+        bool Translucent;
+        uint8_t SortLayer;
+        float ShapeTexIndex; // Kind为Shape时的纹理索引
+    };
+
+    // 工作线程的提交上下文：顶点（或实例）在工作线程上生成，纹理只记录在上下文纹理表里的下标，合并时再分配纹理槽
+    struct ThreadQuad
+    {
+        QueuedTextureKind Kind;
+        uint32_t Texture;
+    };
+
+    struct ThreadContext
+    {
+        bool Active = false;
+        bool Instanced = false; // BeginThreadSubmission时的渲染模式
+        uint32_t CulledQuads = 0;
+        uint32_t OccludedQuads = 0;
+        uint32_t TextGlyphs = 0;
+        uint32_t Shapes = 0;
+        std::vector<QuadVertex> Vertices; // 每个矩形4个
+        std::vector<ThreadQuad> VertexQuads;
+        std::vector<QuadInstance> Instances;
+        std::vector<ThreadQuad> InstanceQuads;
+        std::vector<Ref<Texture2D>> Textures;
+        std::vector<Ref<Texture2DArray>> Arrays;
+        std::unordered_map<const Texture*, uint32_t> TextureLookup;
+    };
+
+    // 当前线程正在使用的上下文，渲染线程上为空
+    static thread_local ThreadContext* t_ThreadContext = nullptr;
+
     struct Renderer2DData{
-        static const uint32_t MaxQuads = 10000;
-        static const uint32_t MaxVertices = MaxQuads * 4;
-        static const uint32_t MaxIndices = MaxQuads * 6;
-        // 纹理最大值取决于GPU，至少有8个，我的mac笔记本上是16个
-        static const uint32_t MaxTexturesSlots = 16; // TODO:RenderCaps
+        // 批次大小和纹理槽数量在Init时根据RenderCaps确定
+        static constexpr uint32_t DefaultMaxQuads = 10000;
+        static constexpr uint32_t MaxQuadsLimit = 20000;
+        // 纹理最大值取决于GPU，至少有16个，采样器数组太大时shader里的动态索引会变慢，所以设个上限
+        static constexpr uint32_t MaxTexturesSlotsLimit = 32;
+        uint32_t MaxQuads = DefaultMaxQuads;
+        uint32_t MaxVertices = DefaultMaxQuads * 4;
+        uint32_t MaxIndices = DefaultMaxQuads * 6;
+        uint32_t MaxTexturesSlots = 16;
+        // 带光照的变体在片元阶段多用两个采样器（光源和瓦片表），开启光照时批次只用这么多纹理槽
+        uint32_t LitTexturesSlots = 14;
         Ref<VertexArray> QuadVertexArray;
         Ref<VertexBuffer> QuadVertexBuffer;
         Ref<Shader> TextureShader;
         Ref<Texture2D> WhiteTexture;
         uint32_t QuadIndexCount = 0;
-        QuadVertex* QuadVertexBufferBase = nullptr;
-        QuadVertex* QuadVertexBufferPtr = nullptr;
-
-        std::array<Ref<Texture2D>, MaxTexturesSlots> TextureSlots;
+        // 当前批次顶点写入的起始地址，指向QuadVertexStagingBase或者流式缓冲映射出来的区域
+        // 顶点类型取决于PackedVertices，是QuadVertex或者PackedQuadVertex
+        uint8_t* QuadVertexBufferBase = nullptr;
+        uint8_t* QuadVertexBufferPtr = nullptr;
+        QuadVertex* QuadVertexStagingBase = nullptr;
+
+        // 压缩顶点格式，复用暂存数组和流式缓冲，只是各自有一套顶点数组和shader
+        bool PackedVertices = false;
+        Ref<VertexArray> PackedQuadVertexArray;
+        Ref<VertexBuffer> PackedQuadVertexBuffer;
+        Ref<Shader> PackedTextureShader;
+
+        // 纹理数组批次：整个批次只采样一个Texture2DArray，纹理索引是层号，三种顶点格式各有一个shader
+        Ref<Texture2DArray> BatchTextureArray; // 为空时批次使用纹理槽
+        Ref<Shader> TextureArrayShader;
+        Ref<Shader> PackedTextureArrayShader;
+        Ref<Shader> InstancedTextureArrayShader;
+
+        // 流式上传：顶点直接写进映射出来的环形缓冲区域，省掉暂存数组到GPU的那次拷贝
+        static const uint32_t StreamRegionCount = 3;
+        bool StreamingUpload = false;
+        Ref<VertexArray> StreamVertexArray;
+        Ref<VertexArray> StreamPackedVertexArray;
+        Ref<StreamingVertexBuffer> StreamVertexBuffer;
+        bool StreamMapped = false;      // 当前批次的顶点正写在映射区域里
+        bool StreamPending = false;     // 区域已解除映射，等待Flush绘制并插入fence
+        uint32_t StreamBaseVertex = 0;  // 当前批次所在区域的第一个顶点
+
+        Renderer2D::QuadRenderMode RenderMode = Renderer2D::QuadRenderMode::Batched;
+        Ref<VertexArray> QuadInstanceVertexArray;
+        Ref<VertexBuffer> QuadInstanceBuffer;
+        Ref<Shader> InstancedTextureShader;
+        uint32_t QuadInstanceCount = 0;
+        QuadInstance* QuadInstanceBufferBase = nullptr;
+        QuadInstance* QuadInstanceBufferPtr = nullptr;
+
+        // 顶点拉取：实例记录写进纹理缓冲，vertex shader用gl_VertexID算出矩形下标和角，glDrawArrays绘制，不需要索引缓冲
+        // 批次只受纹理缓冲大小限制，暂存数组和实例化模式共用，按两者中较大的容量分配
+        static constexpr uint32_t PulledQuadsLimit = 131072;
+        uint32_t MaxPulledQuads = DefaultMaxQuads;
+        uint32_t QuadRecordSlot = 16; // 纹理缓冲绑定的纹理单元，排在纹理槽后面
+        Ref<VertexArray> PulledQuadVertexArray; // 没有任何属性，core profile绘制时必须绑定一个
+        Ref<TextureBuffer> QuadRecordBuffer;
+        Ref<Shader> PulledTextureShader;
+        Ref<Shader> PulledTextureArrayShader;
+
+        std::vector<Ref<Texture2D>> TextureSlots;
         uint32_t TextureSlotIndex = 1; // 0 = white texture
 
-        glm::vec4 QuadVertexPositions[4]; // 矩形的四个顶点
+        // 纹理到槽位的直接映射表，按RendererID低位索引，表项记录写入时的批次号，批次切换后自动失效
+        struct TextureSlotEntry
+        {
+            uint32_t RendererID = 0;
+            uint32_t BatchIndex = 0;
+            uint32_t Slot = 0;
+        };
+        static const uint32_t TextureSlotTableSize = 64; // 2的幂
+        std::array<TextureSlotEntry, TextureSlotTableSize> TextureSlotTable;
+        uint32_t BatchIndex = 0;
+
+        // DrawQuads的临时数据，一次最多处理一个批次的矩形
+        std::vector<float> CornerXs;
+        std::vector<float> CornerYs;
+        std::vector<float> Rotations;
+
+        // 视锥剔除：BeginScene时由相机算出的世界空间可见区域
+        bool Culling = true;
+        glm::vec2 ViewMin = glm::vec2(-std::numeric_limits<float>::max());
+        glm::vec2 ViewMax = glm::vec2(std::numeric_limits<float>::max());
+        // 遮挡剔除：BeginScene时按可见区域清空，工作线程提交期间只读
+        bool OcclusionCulling = false;
+        OcclusionBuffer Occlusion;
+        // DrawQuads剔除之后剩下的矩形，有矩形被剔除时才使用
+        std::vector<glm::vec2> CullPositions;
+        std::vector<glm::vec2> CullSizes;
+        std::vector<float> CullDepths;
+        std::vector<float> CullRotations;
+        std::vector<glm::vec4> CullColors;
+        std::vector<Ref<Texture2D>> CullTextures;
+        std::vector<float> CullTilingFactors;
+
+        // 排序提交的队列和本帧用到的纹理，纹理在EndScene之前一直被持有
+        bool SortedSubmission = false;
+        uint8_t SortLayer = 0;
+        std::vector<QueuedQuad> QueuedQuads;
+        std::vector<Ref<Texture2D>> QueueTextures;
+        std::vector<Ref<Texture2DArray>> QueueArrays;
+        std::unordered_map<const Texture*, uint32_t> QueueTextureLookup;
+        RenderQueue QuadQueue;
+        bool TranslucentPass = false; // 正在画半透明pass，深度写入已关闭
+
+        // 任意三角形：多边形的顶点和矩形写进同一个顶点流。批次里出现多边形之后索引不再是固定的矩形模式，
+        // 改为在CPU上生成整个批次的索引，绘制时临时换上动态索引缓冲，仍然是一次draw call
+        Ref<IndexBuffer> QuadIndexBuffer;
+        Ref<IndexBuffer> PolygonIndexBuffer;
+        bool PolygonBatch = false;
+        std::vector<uint32_t> PolygonIndices; // 当前批次的实际索引，容量为MaxIndices
+        uint32_t PolygonSyncVertex = 0;       // PolygonIndices已经覆盖到的顶点数，之后写入的顶点都是矩形
+        // DrawPolygon的临时数据
+        std::vector<uint32_t> TriangulatedIndices;
+        std::vector<glm::vec2> PolygonTexCoords;
+
+        // 分块光照：每个Texture.glsl变体都有一个带HZ_LIGHTING的版本，按原来的shader查找
+        Ref<LightGrid> Lighting;
+        std::unordered_map<const Shader*, Ref<Shader>> LitShaders;
+        // 光源和瓦片表绑定的纹理单元，排在QuadRecordSlot后面
+        uint32_t LightsSlot = 17;
+        uint32_t LightGridSlot = 18;
+
+        // 瓦片地图：每个块画一个单位矩形，位置和瓦片编号纹理由uniform指定
+        Ref<VertexArray> TilemapVertexArray;
+        Ref<Shader> TilemapShader;
+
+        // 按下标保存的工作线程上下文，合并后清空但保留容量，下一帧复用
+        std::vector<std::unique_ptr<ThreadContext>> ThreadContexts;
+        std::mutex ThreadContextMutex;
 
         Renderer2D::Statistics Stats;
     };
 
     static Renderer2DData* s_Data;
 
-    void Renderer2D::Init() {
-        HZ_PROFILE_FUNCTION();
-        s_Data = new Renderer2DData();
-        s_Data->QuadVertexArray = Hazel::VertexArray::Create();
-        // 创建顶点缓冲，按照预设的最大值MaxVertices来申请空间
-        s_Data->QuadVertexBuffer = VertexBuffer::Create(s_Data->MaxVertices * sizeof(QuadVertex));
-        // 设置顶点数据的布局属性，按照position、color、texCoord的顺序排列
-        s_Data->QuadVertexBuffer->SetLayout(
+    static const BufferLayout& GetQuadVertexLayout() {
+        // 按照position、color、texCoord的顺序排列
+        static const BufferLayout layout = {
+            {ShaderDataType::Float3, "a_Position"},
+            {ShaderDataType::Float4, "a_Color"},
+            {ShaderDataType::Float2, "a_TexCoord"},
+            {ShaderDataType::Float, "a_TexIndex"},
+            {ShaderDataType::Float, "a_TilingFactor"},
+        };
+        return layout;
+    }
+
+    // QuadInstance的布局，divisor为1时按实例读取；GPU剔除时同样的记录按顶点读取（divisor为0）
+    static BufferLayout GetQuadInstanceLayout(uint32_t divisor) {
+        return BufferLayout(
             {
                 {ShaderDataType::Float3, "a_Position"},
+                {ShaderDataType::Float2, "a_Size"},
+                {ShaderDataType::Float, "a_Rotation"},
                 {ShaderDataType::Float4, "a_Color"},
-                {ShaderDataType::Float2, "a_TexCoord"},
+                {ShaderDataType::Float4, "a_TexRect"},
                 {ShaderDataType::Float, "a_TexIndex"},
                 {ShaderDataType::Float, "a_TilingFactor"},
-            }
-        );
-        // 顶点缓冲绑定到顶点数组中，s_Data->QuadVertexBuffer在GPU内存中，现在只有内存占用无数据
-        s_Data->QuadVertexArray->AddVertexBuffer(s_Data->QuadVertexBuffer);
-        // 创建CPU空间的顶点数据，也是按照最大预设置来创建
-        s_Data->QuadVertexBufferBase = new QuadVertex[s_Data->MaxVertices];
-        // 创建索引数组
-        uint32_t* quadIndices = new uint32_t[s_Data->MaxIndices];
+            }, divisor);
+    }
+
+    // quadCount个矩形的索引，每个矩形对应4个顶点，对应6个索引值
+    static Ref<IndexBuffer> CreateQuadIndexBuffer(uint32_t quadCount) {
+        const uint32_t indexCount = quadCount * 6;
+        uint32_t* quadIndices = new uint32_t[indexCount];
         uint32_t  offset = 0;
         // 1个矩形对应4个顶点，对应6个索引值，所以offset间隔为4,indice间隔为6
-        for (uint32_t i = 0; i < s_Data->MaxIndices; i+= 6) {
+        for (uint32_t i = 0; i < indexCount; i+= 6) {
             quadIndices[i+0] = offset + 0;
             quadIndices[i+1] = offset + 1;
             quadIndices[i+2] = offset + 2;
@@ -74,326 +308,2182 @@ namespace Hazel {
             quadIndices[i+5] = offset + 0;
             offset += 4;
         }
-        Ref<IndexBuffer> quadIB = IndexBuffer::Create(quadIndices, s_Data->MaxIndices);
+        Ref<IndexBuffer> indexBuffer = IndexBuffer::Create(quadIndices, indexCount);
+        delete[] quadIndices;
+        return indexBuffer;
+    }
+
+    // Texture.glsl的一个变体，同时编译带光照的版本，光照版本的采样器数组按LitTexturesSlots声明
+    static Ref<Shader> CreateQuadShader(std::vector<std::string> defines) {
+        Ref<Shader> shader = Shader::Create("../assets/shaders/Texture.glsl", defines);
+        for (auto& define : defines) {
+            if (define.rfind("HZ_MAX_TEXTURE_SLOTS ", 0) == 0) {
+                define = "HZ_MAX_TEXTURE_SLOTS " + std::to_string(s_Data->LitTexturesSlots);
+            }
+        }
+        defines.push_back("HZ_LIGHTING");
+        s_Data->LitShaders[shader.get()] = Shader::Create("../assets/shaders/Texture.glsl", defines);
+        return shader;
+    }
+
+    void Renderer2D::Init() {
+        HZ_PROFILE_FUNCTION();
+        s_Data = new Renderer2DData();
+
+        // 驱动给出的单次绘制建议顶点/索引数比默认批次大时放大批次，但不低于默认值
+        const RenderCaps& caps = RenderCaps::Get();
+        uint32_t preferredQuads = std::min(caps.MaxElementsVertices / 4, caps.MaxElementsIndices / 6);
+        s_Data->MaxQuads = std::clamp(preferredQuads, Renderer2DData::DefaultMaxQuads, Renderer2DData::MaxQuadsLimit);
+        s_Data->MaxVertices = s_Data->MaxQuads * 4;
+        s_Data->MaxIndices = s_Data->MaxQuads * 6;
+        s_Data->MaxTexturesSlots = std::min(caps.MaxTextureSlots, Renderer2DData::MaxTexturesSlotsLimit);
+        // 光照变体给光源和瓦片表留出两个采样器，不开光照的批次仍然用满所有纹理槽
+        s_Data->LitTexturesSlots = std::min(caps.MaxTextureSlots - 2, s_Data->MaxTexturesSlots);
+        // 每个矩形4个纹素
+        s_Data->MaxPulledQuads = std::min(caps.MaxTextureBufferSize / 4, Renderer2DData::PulledQuadsLimit);
+        s_Data->QuadRecordSlot = s_Data->MaxTexturesSlots;
+        s_Data->LightsSlot = s_Data->QuadRecordSlot + 1;
+        s_Data->LightGridSlot = s_Data->QuadRecordSlot + 2;
+        HZ_CORE_INFO("Renderer2D: {0} quads per batch ({1} with vertex pulling), {2} texture slots ({3} lit)", s_Data->MaxQuads,
+                     s_Data->MaxPulledQuads, s_Data->MaxTexturesSlots, s_Data->LitTexturesSlots);
+
+        s_Data->QuadVertexArray = Hazel::VertexArray::Create();
+        // 创建顶点缓冲，按照预设的最大值MaxVertices来申请空间
+        s_Data->QuadVertexBuffer = VertexBuffer::Create(s_Data->MaxVertices * sizeof(QuadVertex));
+        // 设置顶点数据的布局属性
+        s_Data->QuadVertexBuffer->SetLayout(GetQuadVertexLayout());
+        // 顶点缓冲绑定到顶点数组中，s_Data->QuadVertexBuffer在GPU内存中，现在只有内存占用无数据
+        s_Data->QuadVertexArray->AddVertexBuffer(s_Data->QuadVertexBuffer);
+        // 创建CPU空间的顶点数据，也是按照最大预设置来创建
+        s_Data->QuadVertexStagingBase = new QuadVertex[s_Data->MaxVertices];
+        s_Data->CornerXs.resize(s_Data->MaxVertices);
+        s_Data->CornerYs.resize(s_Data->MaxVertices);
+        s_Data->Rotations.resize(s_Data->MaxQuads);
+        // 创建索引缓冲
+        Ref<IndexBuffer> quadIB = CreateQuadIndexBuffer(s_Data->MaxQuads);
         // 绑定索引缓冲到顶点数组
         s_Data->QuadVertexArray->SetIndexBuffer(quadIB);
-        delete[] quadIndices;
+        s_Data->QuadIndexBuffer = quadIB;
+        // 多边形批次的索引缓冲，矩形和多边形按占用的索引数计入批次容量，实际索引数不会超过MaxIndices
+        s_Data->PolygonIndexBuffer = IndexBuffer::Create(s_Data->MaxIndices);
+        s_Data->PolygonIndices.reserve(s_Data->MaxIndices);
+
+        BufferLayout packedLayout = {
+            {ShaderDataType::Float2, "a_Position"},
+            {ShaderDataType::Half2, "a_DepthTexIndex"},
+            {ShaderDataType::Half2, "a_TexCoord"},
+            {ShaderDataType::UByte4Norm, "a_Color"},
+        };
+        s_Data->PackedQuadVertexArray = VertexArray::Create();
+        s_Data->PackedQuadVertexBuffer = VertexBuffer::Create(s_Data->MaxVertices * sizeof(PackedQuadVertex));
+        s_Data->PackedQuadVertexBuffer->SetLayout(packedLayout);
+        s_Data->PackedQuadVertexArray->AddVertexBuffer(s_Data->PackedQuadVertexBuffer);
+        s_Data->PackedQuadVertexArray->SetIndexBuffer(quadIB);
+
+        // 流式路径：布局和QuadVertexBuffer一样，每个区域放一个完整批次，绘制时用baseVertex定位到区域
+        s_Data->StreamVertexArray = VertexArray::Create();
+        s_Data->StreamVertexBuffer = StreamingVertexBuffer::Create(s_Data->MaxVertices * sizeof(QuadVertex), Renderer2DData::StreamRegionCount);
+        s_Data->StreamVertexBuffer->SetLayout(s_Data->QuadVertexBuffer->GetLayout());
+        s_Data->StreamVertexArray->AddVertexBuffer(s_Data->StreamVertexBuffer);
+        s_Data->StreamVertexArray->SetIndexBuffer(quadIB);
+        // 同一块流式缓冲也可以按压缩格式解释，布局只在AddVertexBuffer时读取
+        s_Data->StreamPackedVertexArray = VertexArray::Create();
+        s_Data->StreamVertexBuffer->SetLayout(packedLayout);
+        s_Data->StreamPackedVertexArray->AddVertexBuffer(s_Data->StreamVertexBuffer);
+        s_Data->StreamPackedVertexArray->SetIndexBuffer(quadIB);
+
+        // 实例化路径：没有逐顶点缓冲，只有一个divisor为1的实例缓冲，索引复用quadIB的前6个
+        s_Data->QuadInstanceVertexArray = VertexArray::Create();
+        s_Data->QuadInstanceBuffer = VertexBuffer::Create(s_Data->MaxQuads * sizeof(QuadInstance));
+        s_Data->QuadInstanceBuffer->SetLayout(GetQuadInstanceLayout(1));
+        s_Data->QuadInstanceVertexArray->AddVertexBuffer(s_Data->QuadInstanceBuffer);
+        s_Data->QuadInstanceVertexArray->SetIndexBuffer(quadIB);
+        s_Data->QuadInstanceBufferBase = new QuadInstance[std::max(s_Data->MaxQuads, s_Data->MaxPulledQuads)];
+
+        // 顶点拉取路径：空的顶点数组，记录全部在纹理缓冲里
+        s_Data->PulledQuadVertexArray = VertexArray::Create();
+        s_Data->QuadRecordBuffer = TextureBuffer::Create(s_Data->MaxPulledQuads * sizeof(QuadInstance));
+
+        // 瓦片地图的单位矩形，顶点顺序和其它矩形一致，索引同样复用quadIB的前6个
+        float tilemapVertices[4 * 2] = {0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f};
+        Ref<VertexBuffer> tilemapVB = VertexBuffer::Create(tilemapVertices, sizeof(tilemapVertices));
+        tilemapVB->SetLayout({{ShaderDataType::Float2, "a_Position"}});
+        s_Data->TilemapVertexArray = VertexArray::Create();
+        s_Data->TilemapVertexArray->AddVertexBuffer(tilemapVB);
+        s_Data->TilemapVertexArray->SetIndexBuffer(quadIB);
+        s_Data->TilemapShader = Shader::Create("../assets/shaders/Tilemap.glsl");
+        s_Data->TilemapShader->Bind();
+        s_Data->TilemapShader->SetInt("u_Tileset", 0);
+        s_Data->TilemapShader->SetInt("u_TileIndices", 1);
         // 创建1*1的纯色纹理
         s_Data->WhiteTexture = Texture2D::Create(1, 1);
         // 纹理颜色为白色
         uint32_t whiteTextureData = 0xffffffff;
         s_Data->WhiteTexture->SetData(&whiteTextureData, sizeof(uint32_t));
-        int32_t samplers[Hazel::Renderer2DData::MaxTexturesSlots];
-        for (uint32_t i = 0; i < Hazel::Renderer2DData::MaxTexturesSlots; i++) {
+        std::vector<int32_t> samplers(s_Data->MaxTexturesSlots);
+        for (uint32_t i = 0; i < s_Data->MaxTexturesSlots; i++) {
             samplers[i] = i;
         }
-        s_Data->TextureShader = Shader::Create("../assets/shaders/Texture.glsl");
+        // shader里采样器数组的长度和纹理槽数量一致
+        const std::string slotsDefine = "HZ_MAX_TEXTURE_SLOTS " + std::to_string(s_Data->MaxTexturesSlots);
+        // 纹理槽批次里的文字字形按距离场采样，和精灵在同一个批次里绘制
+        const std::string distanceFieldDefine = "HZ_DISTANCE_FIELD_OFFSET " + std::to_string((int)DistanceFieldTexIndexOffset) + ".0";
+        s_Data->TextureShader = CreateQuadShader({slotsDefine, distanceFieldDefine});
         s_Data->TextureShader->Bind();
-        s_Data->TextureShader->SetIntArray("u_Textures", samplers, Hazel::Renderer2DData::MaxTexturesSlots);
+        s_Data->TextureShader->SetIntArray("u_Textures", samplers.data(), s_Data->MaxTexturesSlots);
+        s_Data->InstancedTextureShader = CreateQuadShader({"HZ_INSTANCED", slotsDefine, distanceFieldDefine});
+        s_Data->InstancedTextureShader->Bind();
+        s_Data->InstancedTextureShader->SetIntArray("u_Textures", samplers.data(), s_Data->MaxTexturesSlots);
+        s_Data->PackedTextureShader = CreateQuadShader({"HZ_PACKED_VERTEX", slotsDefine, distanceFieldDefine});
+        s_Data->PackedTextureShader->Bind();
+        s_Data->PackedTextureShader->SetIntArray("u_Textures", samplers.data(), s_Data->MaxTexturesSlots);
+        s_Data->TextureArrayShader = CreateQuadShader({"HZ_TEXTURE_ARRAY"});
+        s_Data->PackedTextureArrayShader = CreateQuadShader({"HZ_PACKED_VERTEX", "HZ_TEXTURE_ARRAY"});
+        s_Data->InstancedTextureArrayShader = CreateQuadShader({"HZ_INSTANCED", "HZ_TEXTURE_ARRAY"});
+        s_Data->PulledTextureArrayShader = CreateQuadShader({"HZ_VERTEX_PULLING", "HZ_TEXTURE_ARRAY"});
+        for (auto& shader : {s_Data->TextureArrayShader, s_Data->PackedTextureArrayShader, s_Data->InstancedTextureArrayShader,
+                             s_Data->PulledTextureArrayShader}) {
+            shader->Bind();
+            shader->SetInt("u_TextureArray", 0);
+        }
+        s_Data->PulledTextureShader = CreateQuadShader({"HZ_VERTEX_PULLING", slotsDefine, distanceFieldDefine});
+        s_Data->PulledTextureShader->Bind();
+        s_Data->PulledTextureShader->SetIntArray("u_Textures", samplers.data(), s_Data->MaxTexturesSlots);
+        for (auto& shader : {s_Data->PulledTextureShader, s_Data->PulledTextureArrayShader}) {
+            shader->Bind();
+            shader->SetInt("u_QuadRecords", (int)s_Data->QuadRecordSlot);
+        }
+        // 带光照的变体：采样器和原来的版本一样，另外是光源和瓦片表；变体里没有的uniform会被忽略
+        for (auto& [shader, litShader] : s_Data->LitShaders) {
+            litShader->Bind();
+            litShader->SetIntArray("u_Textures", samplers.data(), s_Data->LitTexturesSlots);
+            litShader->SetInt("u_TextureArray", 0);
+            litShader->SetInt("u_QuadRecords", (int)s_Data->QuadRecordSlot);
+            litShader->SetInt("u_Lights", (int)s_Data->LightsSlot);
+            litShader->SetInt("u_LightGrid", (int)s_Data->LightGridSlot);
+        }
         // Set all texture slots to 0
         // 安全起见，将数组中的每个值都初始化成一个默认的纹理，即单像素纹理
-        for (int i = 0; i < s_Data->MaxTexturesSlots; i++) {
-            s_Data->TextureSlots[i] = s_Data->WhiteTexture;
-        }
-
-        // 初始化单位矩阵的顶点坐标
-        s_Data->QuadVertexPositions[0] = {-0.5f, -0.5f, 0.0f, 1.0f};
-        s_Data->QuadVertexPositions[1] = {0.5f, -0.5f, 0.0f, 1.0f};
-        s_Data->QuadVertexPositions[2] = {0.5f, 0.5f, 0.0f, 1.0f};
-        s_Data->QuadVertexPositions[3] = {-0.5f, 0.5f, 0.0f, 1.0f};
+        s_Data->TextureSlots.assign(s_Data->MaxTexturesSlots, s_Data->WhiteTexture);
     }
 
     void Renderer2D::Shutdown() {
         HZ_PROFILE_FUNCTION();
+        if (s_Data->StreamMapped) {
+            s_Data->StreamVertexBuffer->Unmap(0);
+            s_Data->StreamMapped = false;
+        }
         s_Data->QuadIndexCount = 0;
+        s_Data->QuadVertexBufferBase = (uint8_t*)s_Data->QuadVertexStagingBase;
         s_Data->QuadVertexBufferPtr = s_Data->QuadVertexBufferBase;
         s_Data->TextureSlotIndex = 1;
     }
 
-    void Renderer2D::BeginScene(const OrthographicCamera &camera) {
-        HZ_PROFILE_FUNCTION();
-        s_Data->TextureShader->Bind();
-        s_Data->TextureShader->SetMat4("u_ViewProjection", camera.GetViewProjectionMatrix());
+    // 流式模式下映射下一个区域作为本批次的顶点存储
+    static void MapStreamRegion() {
+        // 上一个批次没有画任何东西时区域还映射着，直接放弃
+        if (s_Data->StreamMapped) {
+            s_Data->StreamVertexBuffer->Unmap(0);
+            s_Data->StreamMapped = false;
+        }
+        if (!s_Data->StreamingUpload) {
+            s_Data->QuadVertexBufferBase = (uint8_t*)s_Data->QuadVertexStagingBase;
+            return;
+        }
+
+        s_Data->QuadVertexBufferBase = (uint8_t*)s_Data->StreamVertexBuffer->Map();
+        s_Data->StreamMapped = true;
+
+        auto& streamStats = s_Data->StreamVertexBuffer->GetStats();
+        s_Data->Stats.StreamFenceWaits += streamStats.FenceWaits;
+        s_Data->Stats.StreamStallTime += streamStats.StallTime;
+        s_Data->Stats.StreamOrphans += streamStats.Orphans;
+        s_Data->StreamVertexBuffer->ResetStats();
+    }
+
+    static void StartBatch() {
+        MapStreamRegion();
+
         s_Data->QuadIndexCount = 0;
         s_Data->QuadVertexBufferPtr = s_Data->QuadVertexBufferBase;
+
+        s_Data->QuadInstanceCount = 0;
+        s_Data->QuadInstanceBufferPtr = s_Data->QuadInstanceBufferBase;
+
+        s_Data->PolygonBatch = false;
+        s_Data->PolygonIndices.clear();
+        s_Data->PolygonSyncVertex = 0;
+
         s_Data->TextureSlotIndex = 1;
+        s_Data->BatchTextureArray = nullptr;
+        // 批次号变化后旧表项全部失效，不需要清空表；回绕时才清一次
+        if (++s_Data->BatchIndex == 0) {
+            s_Data->TextureSlotTable.fill({});
+            s_Data->BatchIndex = 1;
+        }
+    }
+
+    void Renderer2D::BeginScene(const OrthographicCamera &camera) {
+        HZ_PROFILE_FUNCTION();
+        for (auto& shader : {s_Data->TextureShader, s_Data->InstancedTextureShader, s_Data->PackedTextureShader,
+                             s_Data->TextureArrayShader, s_Data->InstancedTextureArrayShader, s_Data->PackedTextureArrayShader,
+                             s_Data->PulledTextureShader, s_Data->PulledTextureArrayShader, s_Data->TilemapShader}) {
+            shader->Bind();
+            shader->SetMat4("u_ViewProjection", camera.GetViewProjectionMatrix());
+        }
+        for (auto& [shader, litShader] : s_Data->LitShaders) {
+            litShader->Bind();
+            litShader->SetMat4("u_ViewProjection", camera.GetViewProjectionMatrix());
+        }
+        s_Data->SortLayer = 0;
+
+        camera.GetWorldBounds(s_Data->ViewMin, s_Data->ViewMax);
+        s_Data->Occlusion.Clear(s_Data->ViewMin, s_Data->ViewMax);
+
+        StartBatch();
+    }
+
+    enum class FlushReason
+    {
+        Explicit = 0, BatchFull, TextureSlotsFull, TextureArraySwitch
+    };
+
+    static void CountFlush(FlushReason reason) {
+        switch (reason) {
+            case FlushReason::Explicit:           s_Data->Stats.ExplicitFlushes++; break;
+            case FlushReason::BatchFull:          s_Data->Stats.BatchFullFlushes++; break;
+            case FlushReason::TextureSlotsFull:   s_Data->Stats.TextureSlotFlushes++; break;
+            case FlushReason::TextureArraySwitch: s_Data->Stats.TextureArrayFlushes++; break;
+        }
+    }
+
+    // 当前批次已经写入的顶点数
+    static uint32_t GetBatchVertexCount() {
+        const uint32_t vertexSize = s_Data->PackedVertices ? sizeof(PackedQuadVertex) : sizeof(QuadVertex);
+        return (uint32_t)(s_Data->QuadVertexBufferPtr - s_Data->QuadVertexBufferBase) / vertexSize;
+    }
+
+    // 多边形批次里，上次同步之后写入的顶点都是矩形（每4个一组），按矩形的模式补上索引
+    // 矩形的写入路径因此不需要知道批次里有没有多边形
+    static void SyncPolygonIndices() {
+        const uint32_t vertexCount = GetBatchVertexCount();
+        auto& indices = s_Data->PolygonIndices;
+        for (uint32_t offset = s_Data->PolygonSyncVertex; offset < vertexCount; offset += 4) {
+            indices.insert(indices.end(), {offset + 0, offset + 1, offset + 2, offset + 2, offset + 3, offset + 0});
+        }
+        s_Data->PolygonSyncVertex = vertexCount;
+    }
+
+    // 把当前批次的顶点/实例数据交给GPU
+    static void UploadBatch() {
+        if (s_Data->PolygonBatch) {
+            SyncPolygonIndices();
+            s_Data->PolygonIndexBuffer->SetData(s_Data->PolygonIndices.data(), (uint32_t)s_Data->PolygonIndices.size());
+        }
+        if (s_Data->StreamMapped) {
+            // 顶点已经在GPU可见的内存里了，只需要解除映射
+            uint32_t dataSize = s_Data->QuadVertexBufferPtr - s_Data->QuadVertexBufferBase;
+            uint32_t offset = s_Data->StreamVertexBuffer->Unmap(dataSize);
+            // 区域大小是两种顶点大小的整数倍，偏移可以直接换算成顶点序号
+            s_Data->StreamBaseVertex = offset / (s_Data->PackedVertices ? sizeof(PackedQuadVertex) : sizeof(QuadVertex));
+            s_Data->StreamMapped = false;
+            s_Data->StreamPending = s_Data->QuadIndexCount > 0;
+        } else if (s_Data->QuadIndexCount) {
+            uint32_t dataSize = s_Data->QuadVertexBufferPtr - s_Data->QuadVertexBufferBase;
+            auto& vertexBuffer = s_Data->PackedVertices ? s_Data->PackedQuadVertexBuffer : s_Data->QuadVertexBuffer;
+            vertexBuffer->SetData(s_Data->QuadVertexBufferBase, dataSize);
+        }
+        if (s_Data->QuadInstanceCount) {
+            uint32_t dataSize = (uint8_t*)s_Data->QuadInstanceBufferPtr - (uint8_t*)s_Data->QuadInstanceBufferBase;
+            if (s_Data->RenderMode == Renderer2D::QuadRenderMode::VertexPulling) {
+                s_Data->QuadRecordBuffer->SetData(s_Data->QuadInstanceBufferBase, dataSize);
+            } else {
+                s_Data->QuadInstanceBuffer->SetData(s_Data->QuadInstanceBufferBase, dataSize);
+            }
+        }
+    }
+
+    // 画掉当前批次并开始下一个
+    static void NextBatch(FlushReason reason) {
+        CountFlush(reason);
+        UploadBatch();
+        Renderer2D::Flush();
+        StartBatch();
     }
 
+    static void SubmitQuadQueue();
+    static void MergeThreadContexts();
+
     void Renderer2D::EndScene() {
         HZ_PROFILE_FUNCTION();
-        uint32_t dataSize = (uint8_t*)s_Data->QuadVertexBufferPtr - (uint8_t*)s_Data->QuadVertexBufferBase;
-        s_Data->QuadVertexBuffer->SetData(s_Data->QuadVertexBufferBase, dataSize);
+        SubmitQuadQueue();
+        MergeThreadContexts();
+        if (s_Data->QuadIndexCount || s_Data->QuadInstanceCount) {
+            CountFlush(FlushReason::Explicit);
+        }
+        UploadBatch();
         Flush();
     }
 
+    // 当前批次可以使用的纹理槽数，光照变体的采样器数组更短
+    static uint32_t GetBatchTextureSlots() {
+        return s_Data->Lighting ? s_Data->LitTexturesSlots : s_Data->MaxTexturesSlots;
+    }
+
+    // 绑定绘制矩形用的shader，开启光照时换成对应的光照变体并绑定瓦片表
+    static void BindQuadShader(const Ref<Shader>& shader) {
+        const Ref<LightGrid>& grid = s_Data->Lighting;
+        if (!grid) {
+            shader->Bind();
+            return;
+        }
+
+        const Ref<Shader>& litShader = s_Data->LitShaders[shader.get()];
+        litShader->Bind();
+        litShader->SetFloat4("u_LightGridParams", {(float)grid->GetTileSize(), (float)grid->GetTilesX(), (float)grid->GetTilesY(), 0.0f});
+        litShader->SetFloat3("u_AmbientLight", grid->GetAmbient());
+        grid->Bind(s_Data->LightsSlot, s_Data->LightGridSlot);
+    }
+
     void Renderer2D::Flush()
     {
-        // Bind Textures
-        for (uint32_t i = 0; i < s_Data->TextureSlotIndex; i++) {
-            s_Data->TextureSlots[i]->Bind(i);
+        if (s_Data->QuadIndexCount == 0 && s_Data->QuadInstanceCount == 0) {
+            return; // Nothing to draw
         }
-        // 这里绑定TextureSlotIndex个纹理，但是前面声明了16个纹理，并且在shader中也声明了16个纹理，运行时，会按索引查找所有的纹理，mac上会抛出如下警告日志
-        // 如果你想消除这个警告，将所有的索引都绑定到gpu的纹理上，即将上面这段代码替换成下面这段。
-        //UNSUPPORTED (log once): POSSIBLE ISSUE: unit 2 GLD_TEXTURE_INDEX_2D is unloadable and bound to sampler type (Float) - using zero texture because texture unloadable
-        for (uint32_t i = 0; i < s_Data->MaxTexturesSlots; i++) {
-            s_Data->TextureSlots[i]->Bind(i);
+
+        const bool textureArray = s_Data->BatchTextureArray != nullptr;
+        if (textureArray) {
+            s_Data->BatchTextureArray->Bind(0);
+        } else {
+            // Bind Textures
+            for (uint32_t i = 0; i < s_Data->TextureSlotIndex; i++) {
+                s_Data->TextureSlots[i]->Bind(i);
+            }
+            // 这里绑定TextureSlotIndex个纹理，但是前面声明了16个纹理，并且在shader中也声明了16个纹理，运行时，会按索引查找所有的纹理，mac上会抛出如下警告日志
+            // 如果你想消除这个警告，将所有的索引都绑定到gpu的纹理上，即将上面这段代码替换成下面这段。
+            //UNSUPPORTED (log once): POSSIBLE ISSUE: unit 2 GLD_TEXTURE_INDEX_2D is unloadable and bound to sampler type (Float) - using zero texture because texture unloadable
+            for (uint32_t i = 0; i < s_Data->MaxTexturesSlots; i++) {
+                s_Data->TextureSlots[i]->Bind(i);
+            }
+        }
+
+        auto& vertexShader = s_Data->PackedVertices ? (textureArray ? s_Data->PackedTextureArrayShader : s_Data->PackedTextureShader)
+                                                    : (textureArray ? s_Data->TextureArrayShader : s_Data->TextureShader);
+        // 多边形批次的QuadIndexCount是占用的容量，实际的索引数以PolygonIndices为准
+        const bool polygonBatch = s_Data->PolygonBatch;
+        const uint32_t indexCount = polygonBatch ? (uint32_t)s_Data->PolygonIndices.size() : s_Data->QuadIndexCount;
+        if (s_Data->StreamPending) {
+            auto& vertexArray = s_Data->PackedVertices ? s_Data->StreamPackedVertexArray : s_Data->StreamVertexArray;
+            BindQuadShader(vertexShader);
+            if (polygonBatch) {
+                vertexArray->SetIndexBuffer(s_Data->PolygonIndexBuffer);
+            }
+            vertexArray->Bind();
+            RenderCommand::DrawIndexedBaseVertex(vertexArray, indexCount, s_Data->StreamBaseVertex);
+            if (polygonBatch) {
+                vertexArray->SetIndexBuffer(s_Data->QuadIndexBuffer);
+            }
+            // GPU读完这个区域之前不能再写入
+            s_Data->StreamVertexBuffer->Fence();
+            s_Data->StreamPending = false;
+            s_Data->Stats.DrawCalls++;
+        } else if (s_Data->QuadIndexCount) {
+            auto& vertexArray = s_Data->PackedVertices ? s_Data->PackedQuadVertexArray : s_Data->QuadVertexArray;
+            BindQuadShader(vertexShader);
+            if (polygonBatch) {
+                vertexArray->SetIndexBuffer(s_Data->PolygonIndexBuffer);
+            }
+            vertexArray->Bind();
+            RenderCommand::DrawIndexed(vertexArray, indexCount);
+            if (polygonBatch) {
+                vertexArray->SetIndexBuffer(s_Data->QuadIndexBuffer);
+            }
+            s_Data->Stats.DrawCalls++;
+        }
+        if (s_Data->QuadInstanceCount && s_Data->RenderMode == QuadRenderMode::VertexPulling) {
+            auto& pulledShader = textureArray ? s_Data->PulledTextureArrayShader : s_Data->PulledTextureShader;
+            BindQuadShader(pulledShader);
+            s_Data->QuadRecordBuffer->Bind(s_Data->QuadRecordSlot);
+            s_Data->PulledQuadVertexArray->Bind();
+            // 每个矩形两个三角形，6个顶点
+            RenderCommand::DrawArrays(s_Data->PulledQuadVertexArray, s_Data->QuadInstanceCount * 6);
+            s_Data->Stats.DrawCalls++;
+        } else if (s_Data->QuadInstanceCount) {
+            auto& instancedShader = textureArray ? s_Data->InstancedTextureArrayShader : s_Data->InstancedTextureShader;
+            BindQuadShader(instancedShader);
+            s_Data->QuadInstanceVertexArray->Bind();
+            RenderCommand::DrawIndexedInstanced(s_Data->QuadInstanceVertexArray, 6, s_Data->QuadInstanceCount);
+            s_Data->Stats.DrawCalls++;
         }
-        RenderCommand::DrawIndexed(s_Data->QuadVertexArray, s_Data->QuadIndexCount);
-        s_Data->Stats.DrawCalls++;
     }
 
     void Renderer2D::FlushAndReset() {
-        EndScene();
+        NextBatch(FlushReason::Explicit);
+    }
 
-        s_Data->QuadIndexCount = 0;
-        s_Data->QuadVertexBufferPtr = s_Data->QuadVertexBufferBase;
+    void Renderer2D::SetQuadRenderMode(QuadRenderMode mode) {
+        if (s_Data->RenderMode == mode) {
+            return;
+        }
+        SubmitQuadQueue();
+        // 切换前先把已经提交的部分画出来，保持提交顺序
+        if (s_Data->QuadIndexCount || s_Data->QuadInstanceCount) {
+            FlushAndReset();
+        }
+        s_Data->RenderMode = mode;
+    }
 
-        s_Data->TextureSlotIndex = 1;
+    Renderer2D::QuadRenderMode Renderer2D::GetQuadRenderMode() {
+        return s_Data->RenderMode;
     }
 
-    void Renderer2D::DrawQuad(const glm::vec2 &position, const glm::vec2 &size, const glm::vec4 &color) {
-        DrawQuad({position.x, position.y, 0.0f}, size, color);
+    void Renderer2D::SetStreamingUpload(bool enabled) {
+        if (s_Data->StreamingUpload == enabled) {
+            return;
+        }
+        SubmitQuadQueue();
+        s_Data->StreamingUpload = enabled;
+        // 已经开始的批次按原来的方式画完，下一个批次才使用新的上传方式
+        if (s_Data->QuadIndexCount || s_Data->QuadInstanceCount) {
+            FlushAndReset();
+        }
     }
 
-    // 每个矩形对应4个顶点，即每绘制一个矩形，要添加4个顶点到s_Data中，用s_Data->QuadVertexBufferPtr标记end的地址
-    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, const glm::vec4 &color) {
-        HZ_PROFILE_FUNCTION();
+    bool Renderer2D::IsStreamingUpload() {
+        return s_Data->StreamingUpload;
+    }
+
+    bool Renderer2D::IsStreamingPersistent() {
+        return s_Data->StreamVertexBuffer->IsPersistent();
+    }
 
-        if (s_Data->QuadIndexCount >= Renderer2DData::MaxIndices) {
+    void Renderer2D::SetPackedVertices(bool enabled) {
+        if (s_Data->PackedVertices == enabled) {
+            return;
+        }
+        SubmitQuadQueue();
+        // 同一个批次里不能混用两种顶点格式
+        if (s_Data->QuadIndexCount || s_Data->QuadInstanceCount) {
             FlushAndReset();
         }
+        s_Data->PackedVertices = enabled;
+    }
 
-        const float texIndex = 0.0f; // white Texture
-        const float tilingFactor = 1.0f;
+    bool Renderer2D::IsPackedVertices() {
+        return s_Data->PackedVertices;
+    }
 
-        glm::mat4 transform = glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), {size.x, size.y, 1.0f});
-
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[0];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {0.0f, 0.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
-
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[1];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {1.0f, 0.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
-
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[2];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {1.0f, 1.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
-
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[3];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {0.0f, 1.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
-        s_Data->QuadIndexCount += 6;
+    void Renderer2D::SetSortedSubmission(bool enabled) {
+        if (s_Data->SortedSubmission == enabled) {
+            return;
+        }
+        // 已经排队的矩形先画出来，之后的按新的方式提交
+        SubmitQuadQueue();
+        s_Data->SortedSubmission = enabled;
     }
 
-    void Renderer2D::DrawQuad(const glm::vec2 &position, const glm::vec2 &size, const Ref<Texture2D> &texture, float tilingFactor, const glm::vec4& tintColor) {
-        DrawQuad({position.x, position.y, 0.f}, size, texture, tilingFactor, tintColor);
+    bool Renderer2D::IsSortedSubmission() {
+        return s_Data->SortedSubmission;
     }
 
-    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, const Ref<Texture2D> &texture, float tilingFactor, const glm::vec4& tintColor) {
-        HZ_PROFILE_FUNCTION();
+    void Renderer2D::SetSortLayer(uint8_t layer) {
+        s_Data->SortLayer = layer;
+    }
 
-        if (s_Data->QuadIndexCount >= Renderer2DData::MaxIndices) {
-            FlushAndReset();
+    void Renderer2D::SetCulling(bool enabled) {
+        s_Data->Culling = enabled;
+    }
+
+    bool Renderer2D::IsCulling() {
+        return s_Data->Culling;
+    }
+
+    void Renderer2D::SetOcclusionCulling(bool enabled) {
+        s_Data->OcclusionCulling = enabled;
+    }
+
+    bool Renderer2D::IsOcclusionCulling() {
+        return s_Data->OcclusionCulling;
+    }
+
+    void Renderer2D::AddOccluder(const glm::vec3 &position, const glm::vec2 &size) {
+        HZ_CORE_ASSERT(!t_ThreadContext, "Occluders can only be added on the render thread!");
+        if (!s_Data->OcclusionCulling) {
+            return;
         }
+        const glm::vec2 half = glm::abs(size) * 0.5f;
+        const glm::vec2 center = {position.x, position.y};
+        s_Data->Occlusion.AddOccluder(center - half, center + half, position.z);
+    }
 
-        constexpr glm::vec4 color = {1.0f, 1.0f, 1.0f, 1.0f};
-        float texIndex = 0.0f;
-        for (uint32_t i = 1; i < s_Data->TextureSlotIndex; ++i) {
-            if (*s_Data->TextureSlots[i].get() == *texture.get()) {
-                texIndex = (float)i;
-                break;
-            }
+    void Renderer2D::SetLightGrid(const Ref<LightGrid> &grid) {
+        if (s_Data->Lighting == grid) {
+            return;
         }
-        if (0.0f == texIndex) {
-            texIndex = (float)s_Data->TextureSlotIndex;
-            s_Data->TextureSlots[s_Data->TextureSlotIndex] = texture;
-            s_Data->TextureSlotIndex++;
+        SubmitQuadQueue();
+        // 已经提交的部分按原来的光照画完
+        if (s_Data->QuadIndexCount || s_Data->QuadInstanceCount) {
+            FlushAndReset();
         }
+        s_Data->Lighting = grid;
+    }
+
+    const Ref<LightGrid>& Renderer2D::GetLightGrid() {
+        return s_Data->Lighting;
+    }
+
+    void Renderer2D::GetViewBounds(glm::vec2 &min, glm::vec2 &max) {
+        min = s_Data->ViewMin;
+        max = s_Data->ViewMax;
+    }
+
+    // 实例化和顶点拉取都是每个矩形一条QuadInstance记录，只是上传和绘制的方式不同
+    static bool UsesQuadInstances() {
+        return s_Data->RenderMode != Renderer2D::QuadRenderMode::Batched;
+    }
 
-        glm::mat4 transform = glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), {size.x, size.y, 1.0f});
+    static uint32_t GetMaxQuadInstances() {
+        return s_Data->RenderMode == Renderer2D::QuadRenderMode::VertexPulling ? s_Data->MaxPulledQuads : s_Data->MaxQuads;
+    }
+
+    static bool IsBatchFull() {
+        if (UsesQuadInstances()) {
+            return s_Data->QuadInstanceCount >= GetMaxQuadInstances();
+        }
+        return s_Data->QuadIndexCount >= s_Data->MaxIndices;
+    }
 
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[0];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {0.0f, 0.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
+    static const glm::vec2 s_QuadTexCoords[4] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+
+    // 写入一个矩形的4个顶点，按顶点格式重载，texCoords与顶点顺序一致
+    static void WriteQuadVertices(QuadVertex*& vertex, const float* xs, const float* ys, float z, const glm::vec4& color,
+                                  const glm::vec2* texCoords, float texIndex, float tilingFactor) {
+        for (int i = 0; i < 4; i++) {
+            vertex->Position = {xs[i], ys[i], z};
+            vertex->Color = color;
+            vertex->TexCoord = texCoords[i];
+            vertex->TexIndex = texIndex;
+            vertex->TilingFactor = tilingFactor;
+            vertex++;
+        }
+    }
 
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[1];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {1.0f, 0.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
+    static void WriteQuadVertices(PackedQuadVertex*& vertex, const float* xs, const float* ys, float z, const glm::vec4& color,
+                                  const glm::vec2* texCoords, float texIndex, float tilingFactor) {
+        // 每个矩形只打包一次，四个顶点共用
+        const uint32_t depthTexIndex = glm::packHalf2x16({z, texIndex});
+        const uint32_t packedColor = glm::packUnorm4x8(color);
+        for (int i = 0; i < 4; i++) {
+            vertex->Position = {xs[i], ys[i]};
+            vertex->DepthTexIndex = depthTexIndex;
+            vertex->TexCoord = glm::packHalf2x16(texCoords[i] * tilingFactor);
+            vertex->Color = packedColor;
+            vertex++;
+        }
+    }
 
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[2];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {1.0f, 1.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
+    template<typename Vertex>
+    static void WriteQuad(const float* xs, const float* ys, float z, const glm::vec4& color, const glm::vec2* texCoords, float texIndex, float tilingFactor) {
+        Vertex* vertex = (Vertex*)s_Data->QuadVertexBufferPtr;
+        WriteQuadVertices(vertex, xs, ys, z, color, texCoords, texIndex, tilingFactor);
+        s_Data->QuadVertexBufferPtr = (uint8_t*)vertex;
+    }
 
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[3];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {0.0f, 1.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
+    // 把内核生成的4个顶点写入批次
+    static void WriteQuad(const float* xs, const float* ys, float z, const glm::vec4& color, const glm::vec2* texCoords, float texIndex, float tilingFactor) {
+        if (s_Data->PackedVertices) {
+            WriteQuad<PackedQuadVertex>(xs, ys, z, color, texCoords, texIndex, tilingFactor);
+        } else {
+            WriteQuad<QuadVertex>(xs, ys, z, color, texCoords, texIndex, tilingFactor);
+        }
 
         s_Data->QuadIndexCount += 6;
 
         s_Data->Stats.QuadCount++;
+    }
 
-#if OLD_PATH
-        s_Data->TextureShader->Bind();
-        s_Data->TextureShader->SetFloat4("u_Color", glm::vec4(1.0f));
-        s_Data->TextureShader->SetFloat("u_TilingFactor", tilingFactor);
-        texture->Bind();
-        glm::mat4 transform = glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0), {size.x, size.y, 1.0f});
-        s_Data->TextureShader->SetMat4("u_Transform", transform);
-        s_Data->QuadVertexArray->Bind();
-        RenderCommand::DrawIndexed(s_Data->QuadVertexArray);
-#endif
+    static void FillQuadInstance(QuadInstance& instance, const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color,
+                                 const glm::vec2* texCoords, float texIndex, float tilingFactor) {
+        instance.Position = position;
+        instance.Size = size;
+        instance.Rotation = rotation;
+        instance.Color = color;
+        // 实例只保存矩形区域，取左下和右上两个角
+        instance.TexRect = {texCoords[0].x, texCoords[0].y, texCoords[2].x, texCoords[2].y};
+        instance.TexIndex = texIndex;
+        instance.TilingFactor = tilingFactor;
     }
 
-    void Renderer2D::DrawQuad(const glm::vec2 &position, const glm::vec2 &size, float rotation,
-                                     const glm::vec4 &color) {
-        DrawQuad({position.x, position.y, 0.0f}, size, rotation, color);
+    static void WriteQuadInstance(const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color,
+                                  const glm::vec2* texCoords, float texIndex, float tilingFactor) {
+        FillQuadInstance(*s_Data->QuadInstanceBufferPtr, position, size, rotation, color, texCoords, texIndex, tilingFactor);
+        s_Data->QuadInstanceBufferPtr++;
+
+        s_Data->QuadInstanceCount++;
+
+        s_Data->Stats.QuadCount++;
     }
 
-    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, float rotation,
-                                     const glm::vec4 &color) {
-        HZ_PROFILE_FUNCTION();
+    // 按当前模式提交一个矩形，rotation为弧度
+    static void SubmitQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color,
+                           float texIndex, float tilingFactor, const glm::vec2* texCoords = s_QuadTexCoords) {
+        if (UsesQuadInstances()) {
+            WriteQuadInstance(position, size, rotation, color, texCoords, texIndex, tilingFactor);
+            return;
+        }
 
-        if (s_Data->QuadIndexCount >= Renderer2DData::MaxIndices) {
-            FlushAndReset();
+        // 未旋转的矩形直接加减半尺寸，不需要构建变换矩阵
+        float xs[4], ys[4];
+        if (rotation == 0.0f) {
+            QuadKernel::GenerateCornersAxisAligned({position.x, position.y}, size, xs, ys);
+        } else {
+            QuadKernel::GenerateCorners({position.x, position.y}, size, rotation, xs, ys);
         }
+        WriteQuad(xs, ys, position.z, color, texCoords, texIndex, tilingFactor);
+    }
 
-        const float texIndex = 0.0f; // white Texture
-        const float tilingFactor = 1.0f;
+    static Renderer2DData::TextureSlotEntry& GetTextureSlotEntry(uint32_t rendererID) {
+        return s_Data->TextureSlotTable[rendererID & (Renderer2DData::TextureSlotTableSize - 1)];
+    }
 
-        glm::mat4 transform = glm::translate(glm::mat4(1.0f), position)
-                * glm::rotate(glm::mat4(1.0f), glm::radians(rotation), {0.0f, 0.0f, 1.0f})
-                * glm::scale(glm::mat4(1.0f), {size.x, size.y, 1.0f});
-
-
-        s_Data->TextureShader->SetFloat4("u_Color", color);
-        s_Data->TextureShader->SetFloat("u_TilingFactor", 1.0f);
-        s_Data->WhiteTexture->Bind();
-
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[0];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {0.0f, 0.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
-
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[1];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {1.0f, 0.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
-
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[2];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {1.0f, 1.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
-
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[3];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {0.0f, 1.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
+    // 查找纹理所在的槽位，没有绑定过返回-1
+    static int FindTextureIndex(const Ref<Texture2D>& texture) {
+        const uint32_t rendererID = texture->GetRendererID();
+        const auto& entry = GetTextureSlotEntry(rendererID);
+        // 表项本批次没有写过，说明同一低位的纹理都没有绑定过
+        if (entry.BatchIndex != s_Data->BatchIndex) {
+            return -1;
+        }
+        if (entry.RendererID == rendererID) {
+            return (int)entry.Slot;
+        }
+        // 表项被同一批次的另一张纹理占用，少见，退回到线性查找
+        for (uint32_t i = 1; i < s_Data->TextureSlotIndex; ++i) {
+            if (s_Data->TextureSlots[i]->GetRendererID() == rendererID) {
+                return (int)i;
+            }
+        }
+        return -1;
+    }
 
-        s_Data->QuadIndexCount += 6;
+    static int AddTexture(const Ref<Texture2D>& texture) {
+        const uint32_t slot = s_Data->TextureSlotIndex++;
+        s_Data->TextureSlots[slot] = texture;
 
-        s_Data->Stats.QuadCount++;
+        auto& entry = GetTextureSlotEntry(texture->GetRendererID());
+        if (entry.BatchIndex != s_Data->BatchIndex) {
+            entry = {texture->GetRendererID(), s_Data->BatchIndex, slot};
+        }
+        return (int)slot;
     }
 
-    void Renderer2D::DrawQuad(const glm::vec2 &position, const glm::vec2 &size, float rotation,
-                                     const Ref<Texture2D> &texture, float tilingFactor, const glm::vec4 &tintColor) {
-        DrawQuad({position.x, position.y, 0.0f}, size, rotation, texture, tilingFactor, tintColor);
+    // 查找纹理所在的槽位，不存在则占用一个新槽位，槽位用完时先画掉当前批次
+    static float GetTextureIndex(const Ref<Texture2D>& texture) {
+        // 纹理数组批次里不能再使用纹理槽
+        if (s_Data->BatchTextureArray) {
+            NextBatch(FlushReason::TextureArraySwitch);
+        }
+        int texIndex = FindTextureIndex(texture);
+        if (texIndex < 0) {
+            if (s_Data->TextureSlotIndex >= GetBatchTextureSlots()) {
+                NextBatch(FlushReason::TextureSlotsFull);
+            }
+            texIndex = AddTexture(texture);
+        }
+        return (float)texIndex;
     }
-    
-    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, float rotation,
-                                     const Ref<Texture2D> &texture, float tilingFactor, const glm::vec4 &tintColor) {
-        HZ_PROFILE_FUNCTION();
 
-        if (s_Data->QuadIndexCount >= Renderer2DData::MaxIndices) {
-            FlushAndReset();
+    // 返回层号作为纹理索引；一个批次只能用一个纹理数组，而且不能和纹理槽混用
+    static float GetTextureLayerIndex(const Ref<Texture2DArray>& array, uint32_t layer) {
+        if (s_Data->BatchTextureArray != array) {
+            if (s_Data->BatchTextureArray || s_Data->TextureSlotIndex > 1) {
+                NextBatch(FlushReason::TextureArraySwitch);
+            }
+            s_Data->BatchTextureArray = array;
+        }
+        return (float)layer;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Culling //////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    // 矩形的包围盒和可见区域不相交，或者被遮挡缓冲里更靠前的遮挡物完全盖住时返回true并计数
+    // 旋转的矩形用外接圆，只需要知道角度是否为0，不需要三角函数
+    static bool CullQuad(const glm::vec3& position, const glm::vec2& size, float rotation) {
+        if (!s_Data->Culling && !s_Data->OcclusionCulling) {
+            return false;
         }
 
-        constexpr glm::vec4 color = {1.0f, 1.0f, 1.0f, 1.0f};
+        glm::vec2 half = glm::abs(size) * 0.5f;
+        if (rotation != 0.0f) {
+            half = glm::vec2(glm::length(half));
+        }
+        if (s_Data->Culling && !(position.x + half.x >= s_Data->ViewMin.x && position.x - half.x <= s_Data->ViewMax.x &&
+                                 position.y + half.y >= s_Data->ViewMin.y && position.y - half.y <= s_Data->ViewMax.y)) {
+            // 工作线程上先记在自己的上下文里，合并时再加到统计
+            if (t_ThreadContext) {
+                t_ThreadContext->CulledQuads++;
+            } else {
+                s_Data->Stats.CulledQuads++;
+            }
+            return true;
+        }
 
-        float texIndex = 0.0f;
-        for (uint32_t i = 1; i < s_Data->TextureSlotIndex; ++i) {
-            if (*s_Data->TextureSlots[i].get() == *texture.get()) {
-                texIndex = (float)i;
+        const glm::vec2 center = {position.x, position.y};
+        if (s_Data->OcclusionCulling && s_Data->Occlusion.IsOccluded(center - half, center + half, position.z)) {
+            if (t_ThreadContext) {
+                t_ThreadContext->OccludedQuads++;
+            } else {
+                s_Data->Stats.OccludedQuads++;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // 剔除DrawQuads里不可见的矩形：没有矩形被剔除时直接返回原批次，否则把剩下的矩形复制到临时数组里
+    static const Renderer2D::QuadBatch& CullBatch(const Renderer2D::QuadBatch& batch, Renderer2D::QuadBatch& visible) {
+        if (!s_Data->Culling && !s_Data->OcclusionCulling) {
+            return batch;
+        }
+
+        uint32_t firstCulled = 0;
+        for (; firstCulled < batch.Count; firstCulled++) {
+            const uint32_t i = firstCulled;
+            const glm::vec3 position = {batch.Positions[i], batch.Depths ? batch.Depths[i] : batch.Depth};
+            const float rotation = batch.Rotations ? batch.Rotations[i] : 0.0f;
+            if (CullQuad(position, batch.Sizes[i], rotation)) {
                 break;
             }
         }
+        if (firstCulled == batch.Count) {
+            return batch;
+        }
+
+        s_Data->CullPositions.clear();
+        s_Data->CullSizes.clear();
+        s_Data->CullDepths.clear();
+        s_Data->CullRotations.clear();
+        s_Data->CullColors.clear();
+        s_Data->CullTextures.clear();
+        s_Data->CullTilingFactors.clear();
+        for (uint32_t i = 0; i < batch.Count; i++) {
+            // firstCulled已经计过数了
+            if (i == firstCulled) {
+                continue;
+            }
+            if (i > firstCulled) {
+                const glm::vec3 position = {batch.Positions[i], batch.Depths ? batch.Depths[i] : batch.Depth};
+                if (CullQuad(position, batch.Sizes[i], batch.Rotations ? batch.Rotations[i] : 0.0f)) {
+                    continue;
+                }
+            }
+            s_Data->CullPositions.push_back(batch.Positions[i]);
+            s_Data->CullSizes.push_back(batch.Sizes[i]);
+            if (batch.Depths) s_Data->CullDepths.push_back(batch.Depths[i]);
+            if (batch.Rotations) s_Data->CullRotations.push_back(batch.Rotations[i]);
+            if (batch.Colors) s_Data->CullColors.push_back(batch.Colors[i]);
+            if (batch.Textures) s_Data->CullTextures.push_back(batch.Textures[i]);
+            if (batch.TilingFactors) s_Data->CullTilingFactors.push_back(batch.TilingFactors[i]);
+        }
 
-        if (0.0f == texIndex) {
-            texIndex = (float)s_Data->TextureSlotIndex;
-            s_Data->TextureSlots[s_Data->TextureSlotIndex] = texture;
-            s_Data->TextureSlotIndex++;
-        }
-
-        glm::mat4 transform = glm::translate(glm::mat4(1.0f), position)
-                              * glm::rotate(glm::mat4(1.0f), glm::radians(rotation), {0.0f, 0.0f, 1.0f})
-                              * glm::scale(glm::mat4(1.0f), {size.x, size.y, 1.0f});
-
-        s_Data->TextureShader->SetMat4("u_Transform", transform);
-        s_Data->QuadVertexArray->Bind();
-        RenderCommand::DrawIndexed(s_Data->QuadVertexArray);
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[0];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {0.0f, 0.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
-
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[1];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {1.0f, 0.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
-
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[2];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {1.0f, 1.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
-
-        s_Data->QuadVertexBufferPtr->Position = transform * s_Data->QuadVertexPositions[3];
-        s_Data->QuadVertexBufferPtr->Color = color;
-        s_Data->QuadVertexBufferPtr->TexCoord = {0.0f, 1.0f};
-        s_Data->QuadVertexBufferPtr->TexIndex = texIndex;
-        s_Data->QuadVertexBufferPtr->TilingFactor = tilingFactor;
-        s_Data->QuadVertexBufferPtr++;
+        visible = batch;
+        visible.Count = (uint32_t)s_Data->CullPositions.size();
+        visible.Positions = s_Data->CullPositions.data();
+        visible.Sizes = s_Data->CullSizes.data();
+        visible.Depths = batch.Depths ? s_Data->CullDepths.data() : nullptr;
+        visible.Rotations = batch.Rotations ? s_Data->CullRotations.data() : nullptr;
+        visible.Colors = batch.Colors ? s_Data->CullColors.data() : nullptr;
+        visible.Textures = batch.Textures ? s_Data->CullTextures.data() : nullptr;
+        visible.TilingFactors = batch.TilingFactors ? s_Data->CullTilingFactors.data() : nullptr;
+        return visible;
+    }
 
-        s_Data->QuadIndexCount += 6;
+    /////////////////////////////////////////////////////////////////////////////
+    // Sorted submission ////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    static QueuedQuad& EnqueueQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color, float tilingFactor) {
+        QueuedQuad& quad = s_Data->QueuedQuads.emplace_back();
+        quad.Position = position;
+        quad.Size = size;
+        quad.Rotation = rotation;
+        quad.Color = color;
+        quad.UVMin = {0.0f, 0.0f};
+        quad.UVMax = {1.0f, 1.0f};
+        quad.TilingFactor = tilingFactor;
+        quad.Texture = 0;
+        quad.ArrayLayer = 0;
+        quad.Kind = QueuedTextureKind::None;
+        quad.Translucent = color.a < 1.0f;
+        quad.SortLayer = s_Data->SortLayer;
+        quad.ShapeTexIndex = NoTextureIndex;
+        return quad;
+    }
 
-        s_Data->Stats.QuadCount++;
+    // 纹理在本帧纹理表里的下标，第一次出现时登记，顺便持有它直到队列画完
+    template<typename T>
+    static uint32_t RegisterQueueTexture(const Ref<T>& texture, std::vector<Ref<T>>& textures,
+                                         std::unordered_map<const Texture*, uint32_t>& lookup) {
+        auto [it, inserted] = lookup.try_emplace(texture.get(), (uint32_t)textures.size());
+        if (inserted) {
+            textures.push_back(texture);
+        }
+        return it->second;
+    }
+
+    static void EnqueueQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color, float tilingFactor,
+                            const Ref<Texture2D>& texture, const glm::vec2& uvMin = glm::vec2(0.0f), const glm::vec2& uvMax = glm::vec2(1.0f),
+                            QueuedTextureKind kind = QueuedTextureKind::Slot) {
+        QueuedQuad& quad = EnqueueQuad(position, size, rotation, color, tilingFactor);
+        quad.UVMin = uvMin;
+        quad.UVMax = uvMax;
+        quad.Texture = RegisterQueueTexture(texture, s_Data->QueueTextures, s_Data->QueueTextureLookup);
+        quad.Kind = kind;
+        quad.Translucent |= texture->HasAlpha();
+    }
+
+    static void EnqueueQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color, float tilingFactor,
+                            const TextureLayer& layer) {
+        QueuedQuad& quad = EnqueueQuad(position, size, rotation, color, tilingFactor);
+        quad.Texture = RegisterQueueTexture(layer.Array, s_Data->QueueArrays, s_Data->QueueTextureLookup);
+        quad.ArrayLayer = layer.Layer;
+        quad.Kind = QueuedTextureKind::Array;
+        quad.Translucent |= layer.Array->HasAlpha();
+    }
+
+    // 材质号：[25:23]纹理类型 [22:0]纹理下标，左移5位后正好占排序键的[30:5]，不能碰到深度的最低位
+    static const uint32_t QueuedMaterialKindShift = 23;
+    static const uint32_t QueuedMaterialBits = 26;
+    static_assert((uint32_t)QueuedTextureKind::Shape < (1u << (QueuedMaterialBits - QueuedMaterialKindShift)),
+                  "QueuedTextureKind must fit in the material's kind field");
+    static_assert(QueuedMaterialBits + 5 <= 31, "material must stay below the depth field of the sort key");
+
+    // 纹理类型和纹理下标合成的材质号，相邻矩形材质号不同就是一次纹理切换；纯色矩形可以放进任何批次，记为0
+    static uint32_t GetQueuedMaterial(const QueuedQuad& quad) {
+        HZ_CORE_ASSERT(quad.Texture < (1u << QueuedMaterialKindShift), "Too many textures in the sort queue!");
+        return ((uint32_t)quad.Kind << QueuedMaterialKindShift) | (quad.Texture & ((1u << QueuedMaterialKindShift) - 1));
+    }
+
+    static const uint64_t TranslucentKeyBit = 1ull << 55;
+
+    // 排序键：[63:56]层 [55]半透明 [54:31]深度 [30:5]材质
+    // 不透明的由近到远，先画的写入深度，后面被挡住的片段在early-Z阶段就被丢掉；半透明的由远到近，保证混合正确
+    // 2D场景里深度的取值一般只有几层，同一深度的矩形仍然按材质排在一起
+    // 正交相机里z越大越靠近屏幕，深度只取有序位的高24位
+    static uint64_t MakeSortKey(const QueuedQuad& quad) {
+        const uint64_t depth = RenderQueue::OrderedBits(quad.Position.z) >> 8;
+        const uint64_t material = GetQueuedMaterial(quad);
+
+        uint64_t key = (uint64_t)quad.SortLayer << 56;
+        if (quad.Translucent) {
+            key |= TranslucentKeyBit;
+            key |= depth << 31;
+        } else {
+            key |= (~depth & 0xffffff) << 31;
+        }
+        key |= material << 5;
+        return key;
+    }
+
+    // 不透明和半透明两个pass之间切换：先画掉当前批次，半透明pass关闭深度写入
+    static void SetTranslucentPass(bool translucent) {
+        if (s_Data->TranslucentPass == translucent) {
+            return;
+        }
+        NextBatch(FlushReason::Explicit);
+        RenderCommand::SetDepthWrite(!translucent);
+        s_Data->TranslucentPass = translucent;
+    }
+
+    static void CountStateChange(const QueuedQuad& quad, int64_t& lastMaterial, uint32_t& changes) {
+        if (quad.Kind == QueuedTextureKind::None || quad.Kind == QueuedTextureKind::Shape) {
+            return;
+        }
+        const int64_t material = GetQueuedMaterial(quad);
+        if (lastMaterial >= 0 && material != lastMaterial) {
+            changes++;
+        }
+        lastMaterial = material;
+    }
+
+    static bool IsQueuedQuadOccluded(const QueuedQuad& quad) {
+        glm::vec2 half = glm::abs(quad.Size) * 0.5f;
+        if (quad.Rotation != 0.0f) {
+            half = glm::vec2(glm::length(half));
+        }
+        const glm::vec2 center = {quad.Position.x, quad.Position.y};
+        return s_Data->Occlusion.IsOccluded(center - half, center + half, quad.Position.z);
+    }
+
+    // 对队列排序并按排好的顺序写入批次，批次的合并和切换沿用立即提交的逻辑
+    static void SubmitQuadQueue() {
+        if (s_Data->QueuedQuads.empty()) {
+            return;
+        }
+        HZ_PROFILE_FUNCTION();
+
+        const auto& quads = s_Data->QueuedQuads;
+        auto& queue = s_Data->QuadQueue;
+        queue.Clear();
+
+        int64_t lastMaterial = -1;
+        for (uint32_t i = 0; i < quads.size(); i++) {
+            queue.Push(MakeSortKey(quads[i]), i);
+            CountStateChange(quads[i], lastMaterial, s_Data->Stats.UnsortedStateChanges);
+        }
+        queue.Sort();
+
+        lastMaterial = -1;
+        for (const auto& entry : queue.GetEntries()) {
+            const QueuedQuad& quad = quads[entry.Index];
+            CountStateChange(quad, lastMaterial, s_Data->Stats.SortedStateChanges);
+
+            // 每一层里不透明的排在半透明的前面，切换时换pass
+            const bool translucent = (entry.Key & TranslucentKeyBit) != 0;
+            SetTranslucentPass(translucent);
+            if (translucent) {
+                s_Data->Stats.TranslucentQuads++;
+            } else {
+                s_Data->Stats.OpaqueQuads++;
+            }
+
+            // 不透明的矩形由近到远提交，前面画过的纯色矩形可能已经把它盖住
+            if (s_Data->OcclusionCulling && !translucent && IsQueuedQuadOccluded(quad)) {
+                s_Data->Stats.OccludedQuads++;
+                continue;
+            }
+
+            if (IsBatchFull()) {
+                NextBatch(FlushReason::BatchFull);
+            }
+
+            float texIndex = NoTextureIndex;
+            if (UsesTextureSlot(quad.Kind)) {
+                texIndex = GetSlotTexIndex(quad.Kind, GetTextureIndex(s_Data->QueueTextures[quad.Texture]));
+            } else if (quad.Kind == QueuedTextureKind::Array) {
+                texIndex = GetTextureLayerIndex(s_Data->QueueArrays[quad.Texture], quad.ArrayLayer);
+            } else if (quad.Kind == QueuedTextureKind::Shape) {
+                texIndex = quad.ShapeTexIndex;
+            }
+            const glm::vec2 texCoords[4] = {{quad.UVMin.x, quad.UVMin.y}, {quad.UVMax.x, quad.UVMin.y},
+                                            {quad.UVMax.x, quad.UVMax.y}, {quad.UVMin.x, quad.UVMax.y}};
+
+            SubmitQuad(quad.Position, quad.Size, quad.Rotation, quad.Color, texIndex, quad.TilingFactor, texCoords);
+
+            // 不透明的纯色矩形每个像素都不透明，可以直接作为后面矩形的遮挡物；带纹理的可能有透明像素，不能自动当作遮挡物
+            if (s_Data->OcclusionCulling && !translucent && quad.Kind == QueuedTextureKind::None && quad.Rotation == 0.0f) {
+                const glm::vec2 half = glm::abs(quad.Size) * 0.5f;
+                const glm::vec2 center = {quad.Position.x, quad.Position.y};
+                s_Data->Occlusion.AddOccluder(center - half, center + half, quad.Position.z);
+            }
+        }
+        // 半透明pass画完后恢复深度写入，后面立即提交的矩形和下一帧的清屏都需要
+        SetTranslucentPass(false);
+        s_Data->Stats.SortedQuads += (uint32_t)quads.size();
+
+        s_Data->QueuedQuads.clear();
+        s_Data->QueueTextures.clear();
+        s_Data->QueueArrays.clear();
+        s_Data->QueueTextureLookup.clear();
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Thread submission ////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    void Renderer2D::BeginThreadSubmission(uint32_t index) {
+        HZ_CORE_ASSERT(!t_ThreadContext, "Thread submission already begun on this thread!");
+
+        ThreadContext* context;
+        {
+            std::lock_guard<std::mutex> lock(s_Data->ThreadContextMutex);
+            auto& contexts = s_Data->ThreadContexts;
+            if (index >= contexts.size()) {
+                contexts.resize(index + 1);
+            }
+            if (!contexts[index]) {
+                contexts[index] = std::make_unique<ThreadContext>();
+            }
+            context = contexts[index].get();
+        }
+
+        HZ_CORE_ASSERT(!context->Active, "Thread submission context is already in use!");
+        context->Active = true;
+        context->Instanced = UsesQuadInstances();
+        t_ThreadContext = context;
+    }
+
+    void Renderer2D::EndThreadSubmission() {
+        HZ_CORE_ASSERT(t_ThreadContext, "Thread submission was not begun on this thread!");
+        t_ThreadContext->Active = false;
+        t_ThreadContext = nullptr;
+    }
+
+    // 在工作线程上生成矩形的顶点或实例，纹理槽要等合并时才能确定，先写占位的索引
+    static void RecordThreadQuad(ThreadContext& context, const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color,
+                                 float tilingFactor, QueuedTextureKind kind, uint32_t texture, float texIndex,
+                                 const glm::vec2* texCoords = s_QuadTexCoords) {
+        if (context.Instanced) {
+            FillQuadInstance(context.Instances.emplace_back(), position, size, rotation, color, texCoords, texIndex, tilingFactor);
+            context.InstanceQuads.push_back({kind, texture});
+            return;
+        }
+
+        float xs[4], ys[4];
+        if (rotation == 0.0f) {
+            QuadKernel::GenerateCornersAxisAligned({position.x, position.y}, size, xs, ys);
+        } else {
+            QuadKernel::GenerateCorners({position.x, position.y}, size, rotation, xs, ys);
+        }
+        const size_t first = context.Vertices.size();
+        context.Vertices.resize(first + 4);
+        QuadVertex* vertex = &context.Vertices[first];
+        WriteQuadVertices(vertex, xs, ys, position.z, color, texCoords, texIndex, tilingFactor);
+        context.VertexQuads.push_back({kind, texture});
+    }
+
+    // 工作线程上的矩形记进本线程的上下文，排序提交时记进队列；返回true表示已经记录，不需要立即写入批次
+    static bool DeferQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color, float tilingFactor) {
+        if (t_ThreadContext) {
+            RecordThreadQuad(*t_ThreadContext, position, size, rotation, color, tilingFactor, QueuedTextureKind::None, 0, NoTextureIndex);
+            return true;
+        }
+        if (s_Data->SortedSubmission) {
+            EnqueueQuad(position, size, rotation, color, tilingFactor);
+            return true;
+        }
+        return false;
+    }
+
+    static bool DeferQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color, float tilingFactor,
+                          const Ref<Texture2D>& texture, const glm::vec2& uvMin = glm::vec2(0.0f), const glm::vec2& uvMax = glm::vec2(1.0f),
+                          QueuedTextureKind kind = QueuedTextureKind::Slot) {
+        if (t_ThreadContext) {
+            ThreadContext& context = *t_ThreadContext;
+            const uint32_t index = RegisterQueueTexture(texture, context.Textures, context.TextureLookup);
+            const glm::vec2 texCoords[4] = {{uvMin.x, uvMin.y}, {uvMax.x, uvMin.y}, {uvMax.x, uvMax.y}, {uvMin.x, uvMax.y}};
+            RecordThreadQuad(context, position, size, rotation, color, tilingFactor, kind, index, 0.0f, texCoords);
+            return true;
+        }
+        if (s_Data->SortedSubmission) {
+            EnqueueQuad(position, size, rotation, color, tilingFactor, texture, uvMin, uvMax, kind);
+            return true;
+        }
+        return false;
+    }
+
+    static bool DeferQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color, float tilingFactor,
+                          const TextureLayer& layer) {
+        if (t_ThreadContext) {
+            ThreadContext& context = *t_ThreadContext;
+            const uint32_t index = RegisterQueueTexture(layer.Array, context.Arrays, context.TextureLookup);
+            // 层号就是最终的纹理索引，合并时只需要切换到这个纹理数组
+            RecordThreadQuad(context, position, size, rotation, color, tilingFactor, QueuedTextureKind::Array, index, (float)layer.Layer);
+            return true;
+        }
+        if (s_Data->SortedSubmission) {
+            EnqueueQuad(position, size, rotation, color, tilingFactor, layer);
+            return true;
+        }
+        return false;
+    }
+
+    // 在渲染线程上为上下文里的矩形分配纹理槽或切换纹理数组，返回纹理槽纹理的最终索引
+    static float ResolveThreadTexture(const ThreadContext& context, const ThreadQuad& quad) {
+        switch (quad.Kind) {
+            case QueuedTextureKind::Slot:
+            case QueuedTextureKind::DistanceField:
+                return GetSlotTexIndex(quad.Kind, GetTextureIndex(context.Textures[quad.Texture]));
+            case QueuedTextureKind::Array:
+                GetTextureLayerIndex(context.Arrays[quad.Texture], 0);
+                break;
+            case QueuedTextureKind::None:
+                break;
+            case QueuedTextureKind::Shape:
+                // 形状的编码在工作线程上已经写进顶点，合并时保留原值
+                break;
+        }
+        return NoTextureIndex;
+    }
+
+    static void MergeThreadVertices(const ThreadContext& context) {
+        for (size_t i = 0; i < context.VertexQuads.size(); i++) {
+            if (s_Data->QuadIndexCount >= s_Data->MaxIndices) {
+                NextBatch(FlushReason::BatchFull);
+            }
+
+            const ThreadQuad& quad = context.VertexQuads[i];
+            const float texIndex = ResolveThreadTexture(context, quad);
+            const QuadVertex* source = &context.Vertices[i * 4];
+
+            if (s_Data->PackedVertices) {
+                // 压缩格式的纹理索引和深度打包在一起，只能重新打包
+                float xs[4], ys[4];
+                glm::vec2 texCoords[4];
+                for (int j = 0; j < 4; j++) {
+                    xs[j] = source[j].Position.x;
+                    ys[j] = source[j].Position.y;
+                    texCoords[j] = source[j].TexCoord;
+                }
+                WriteQuad<PackedQuadVertex>(xs, ys, source->Position.z, source->Color, texCoords,
+                                            UsesTextureSlot(quad.Kind) ? texIndex : source->TexIndex, source->TilingFactor);
+            } else {
+                QuadVertex* vertex = (QuadVertex*)s_Data->QuadVertexBufferPtr;
+                memcpy(vertex, source, 4 * sizeof(QuadVertex));
+                if (UsesTextureSlot(quad.Kind)) {
+                    for (int j = 0; j < 4; j++) {
+                        vertex[j].TexIndex = texIndex;
+                    }
+                }
+                s_Data->QuadVertexBufferPtr = (uint8_t*)(vertex + 4);
+            }
+            s_Data->QuadIndexCount += 6;
+        }
+    }
+
+    static void MergeThreadInstances(const ThreadContext& context) {
+        for (size_t i = 0; i < context.InstanceQuads.size(); i++) {
+            if (s_Data->QuadInstanceCount >= GetMaxQuadInstances()) {
+                NextBatch(FlushReason::BatchFull);
+            }
+
+            const ThreadQuad& quad = context.InstanceQuads[i];
+            const float texIndex = ResolveThreadTexture(context, quad);
+
+            *s_Data->QuadInstanceBufferPtr = context.Instances[i];
+            if (UsesTextureSlot(quad.Kind)) {
+                s_Data->QuadInstanceBufferPtr->TexIndex = texIndex;
+            }
+            s_Data->QuadInstanceBufferPtr++;
+            s_Data->QuadInstanceCount++;
+        }
+    }
+
+    // 按下标顺序把所有工作线程的上下文合并进批次，合并后清空上下文
+    static void MergeThreadContexts() {
+        HZ_PROFILE_FUNCTION();
+
+        for (auto& context : s_Data->ThreadContexts) {
+            if (!context) {
+                continue;
+            }
+            HZ_CORE_ASSERT(!context->Active, "EndScene called while a thread is still submitting!");
+
+            MergeThreadVertices(*context);
+            MergeThreadInstances(*context);
+
+            const uint32_t quadCount = (uint32_t)(context->VertexQuads.size() + context->InstanceQuads.size());
+            s_Data->Stats.QuadCount += quadCount;
+            s_Data->Stats.ThreadQuads += quadCount;
+            s_Data->Stats.CulledQuads += context->CulledQuads;
+            s_Data->Stats.OccludedQuads += context->OccludedQuads;
+            s_Data->Stats.TextGlyphs += context->TextGlyphs;
+            s_Data->Stats.Shapes += context->Shapes;
+            context->CulledQuads = 0;
+            context->OccludedQuads = 0;
+            context->TextGlyphs = 0;
+            context->Shapes = 0;
+
+            context->Vertices.clear();
+            context->VertexQuads.clear();
+            context->Instances.clear();
+            context->InstanceQuads.clear();
+            context->Textures.clear();
+            context->Arrays.clear();
+            context->TextureLookup.clear();
+        }
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec2 &position, const glm::vec2 &size, const glm::vec4 &color) {
+        DrawQuad({position.x, position.y, 0.0f}, size, color);
+    }
+
+    // 每个矩形对应4个顶点，即每绘制一个矩形，要添加4个顶点到s_Data中，用s_Data->QuadVertexBufferPtr标记end的地址
+    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, const glm::vec4 &color) {
+        HZ_PROFILE_FUNCTION();
+
+        if (CullQuad(position, size, 0.0f)) {
+            return;
+        }
+
+        if (DeferQuad(position, size, 0.0f, color, 1.0f)) {
+            return;
+        }
+
+        if (IsBatchFull()) {
+            NextBatch(FlushReason::BatchFull);
+        }
+
+        const float texIndex = NoTextureIndex;
+        const float tilingFactor = 1.0f;
+
+        SubmitQuad(position, size, 0.0f, color, texIndex, tilingFactor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec2 &position, const glm::vec2 &size, const Ref<Texture2D> &texture, float tilingFactor, const glm::vec4& tintColor) {
+        DrawQuad({position.x, position.y, 0.f}, size, texture, tilingFactor, tintColor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, const Ref<Texture2D> &texture, float tilingFactor, const glm::vec4& tintColor) {
+        HZ_PROFILE_FUNCTION();
+
+        if (CullQuad(position, size, 0.0f)) {
+            return;
+        }
+
+        if (DeferQuad(position, size, 0.0f, tintColor, tilingFactor, texture)) {
+            return;
+        }
+
+        if (IsBatchFull()) {
+            NextBatch(FlushReason::BatchFull);
+        }
+
+        float texIndex = GetTextureIndex(texture);
+
+        SubmitQuad(position, size, 0.0f, tintColor, texIndex, tilingFactor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec2 &position, const glm::vec2 &size, float rotation,
+                                     const glm::vec4 &color) {
+        DrawQuad({position.x, position.y, 0.0f}, size, rotation, color);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, float rotation,
+                                     const glm::vec4 &color) {
+        HZ_PROFILE_FUNCTION();
+
+        if (CullQuad(position, size, rotation)) {
+            return;
+        }
+
+        if (DeferQuad(position, size, glm::radians(rotation), color, 1.0f)) {
+            return;
+        }
+
+        if (IsBatchFull()) {
+            NextBatch(FlushReason::BatchFull);
+        }
+
+        const float texIndex = NoTextureIndex;
+        const float tilingFactor = 1.0f;
+
+        SubmitQuad(position, size, glm::radians(rotation), color, texIndex, tilingFactor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec2 &position, const glm::vec2 &size, float rotation,
+                                     const Ref<Texture2D> &texture, float tilingFactor, const glm::vec4 &tintColor) {
+        DrawQuad({position.x, position.y, 0.0f}, size, rotation, texture, tilingFactor, tintColor);
+    }
+    
+    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, float rotation,
+                                     const Ref<Texture2D> &texture, float tilingFactor, const glm::vec4 &tintColor) {
+        HZ_PROFILE_FUNCTION();
+
+        if (CullQuad(position, size, rotation)) {
+            return;
+        }
+
+        if (DeferQuad(position, size, glm::radians(rotation), tintColor, tilingFactor, texture)) {
+            return;
+        }
+
+        if (IsBatchFull()) {
+            NextBatch(FlushReason::BatchFull);
+        }
+
+        float texIndex = GetTextureIndex(texture);
+
+        SubmitQuad(position, size, glm::radians(rotation), tintColor, texIndex, tilingFactor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, float rotation, const Ref<Texture2D> &texture,
+                              const glm::vec2 &uvMin, const glm::vec2 &uvMax, const glm::vec4 &tintColor) {
+        HZ_PROFILE_FUNCTION();
+
+        if (CullQuad(position, size, rotation)) {
+            return;
+        }
+
+        if (DeferQuad(position, size, glm::radians(rotation), tintColor, 1.0f, texture, uvMin, uvMax)) {
+            return;
+        }
+
+        if (IsBatchFull()) {
+            NextBatch(FlushReason::BatchFull);
+        }
+
+        float texIndex = GetTextureIndex(texture);
+        const glm::vec2 texCoords[4] = {{uvMin.x, uvMin.y}, {uvMax.x, uvMin.y}, {uvMax.x, uvMax.y}, {uvMin.x, uvMax.y}};
+
+        SubmitQuad(position, size, glm::radians(rotation), tintColor, texIndex, 1.0f, texCoords);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec2 &position, const glm::vec2 &size, const TextureLayer &layer, float tilingFactor, const glm::vec4 &tintColor) {
+        DrawQuad({position.x, position.y, 0.0f}, size, 0.0f, layer, tilingFactor, tintColor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, const TextureLayer &layer, float tilingFactor, const glm::vec4 &tintColor) {
+        DrawQuad(position, size, 0.0f, layer, tilingFactor, tintColor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, float rotation, const TextureLayer &layer, float tilingFactor, const glm::vec4 &tintColor) {
+        HZ_PROFILE_FUNCTION();
+
+        if (CullQuad(position, size, rotation)) {
+            return;
+        }
+
+        if (DeferQuad(position, size, glm::radians(rotation), tintColor, tilingFactor, layer)) {
+            return;
+        }
+
+        if (IsBatchFull()) {
+            NextBatch(FlushReason::BatchFull);
+        }
+
+        float texIndex = GetTextureLayerIndex(layer.Array, layer.Layer);
+
+        SubmitQuad(position, size, glm::radians(rotation), tintColor, texIndex, tilingFactor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec2 &position, const glm::vec2 &size, const TextureAtlas::Region &region, const glm::vec4 &tintColor) {
+        DrawQuad({position.x, position.y, 0.0f}, size, 0.0f, region.Page, region.UVMin, region.UVMax, tintColor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, const TextureAtlas::Region &region, const glm::vec4 &tintColor) {
+        DrawQuad(position, size, 0.0f, region.Page, region.UVMin, region.UVMax, tintColor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, float rotation, const TextureAtlas::Region &region, const glm::vec4 &tintColor) {
+        DrawQuad(position, size, rotation, region.Page, region.UVMin, region.UVMax, tintColor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec2 &position, const glm::vec2 &size, const Ref<SubTexture2D> &subTexture, const glm::vec4 &tintColor) {
+        DrawQuad({position.x, position.y, 0.0f}, size, 0.0f, subTexture, tintColor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, const Ref<SubTexture2D> &subTexture, const glm::vec4 &tintColor) {
+        DrawQuad(position, size, 0.0f, subTexture, tintColor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec2 &position, const glm::vec2 &size, float rotation, const Ref<SubTexture2D> &subTexture, const glm::vec4 &tintColor) {
+        DrawQuad({position.x, position.y, 0.0f}, size, rotation, subTexture, tintColor);
+    }
+
+    void Renderer2D::DrawQuad(const glm::vec3 &position, const glm::vec2 &size, float rotation, const Ref<SubTexture2D> &subTexture, const glm::vec4 &tintColor) {
+        DrawQuad(position, size, rotation, subTexture->GetTexture(), subTexture->GetUVMin(), subTexture->GetUVMax(), tintColor);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Text /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    // 字形和普通矩形走同样的剔除、延迟提交和批次逻辑，只是纹理索引带上距离场的偏移
+    static void DrawGlyph(const glm::vec3& position, const glm::vec2& size, const glm::vec4& color,
+                          const Ref<Texture2D>& atlas, const glm::vec2& uvMin, const glm::vec2& uvMax) {
+        if (CullQuad(position, size, 0.0f)) {
+            return;
+        }
+        // 工作线程上计入自己的上下文，合并时再加到统计里
+        if (t_ThreadContext) {
+            t_ThreadContext->TextGlyphs++;
+        } else {
+            s_Data->Stats.TextGlyphs++;
+        }
+
+        if (DeferQuad(position, size, 0.0f, color, 1.0f, atlas, uvMin, uvMax, QueuedTextureKind::DistanceField)) {
+            return;
+        }
+
+        if (IsBatchFull()) {
+            NextBatch(FlushReason::BatchFull);
+        }
+
+        float texIndex = GetTextureIndex(atlas) + DistanceFieldTexIndexOffset;
+        const glm::vec2 texCoords[4] = {{uvMin.x, uvMin.y}, {uvMax.x, uvMin.y}, {uvMax.x, uvMax.y}, {uvMin.x, uvMax.y}};
+
+        SubmitQuad(position, size, 0.0f, color, texIndex, 1.0f, texCoords);
+    }
+
+    void Renderer2D::DrawString(const std::string &text, const Ref<Font> &font, const glm::vec2 &position, float size, const glm::vec4 &color) {
+        DrawString(text, font, {position.x, position.y, 0.0f}, size, color);
+    }
+
+    void Renderer2D::DrawString(const std::string &text, const Ref<Font> &font, const glm::vec3 &position, float size, const glm::vec4 &color) {
+        HZ_PROFILE_FUNCTION();
+
+        if (!font->IsLoaded()) {
+            return;
+        }
+
+        const Ref<Texture2D>& atlas = font->GetAtlasTexture();
+        glm::vec2 pen = {position.x, position.y};
+        uint32_t previous = 0;
+        for (char c : text) {
+            const uint32_t codepoint = (uint8_t)c;
+            if (codepoint == '\n') {
+                pen.x = position.x;
+                pen.y -= font->GetLineHeight() * size;
+                previous = 0;
+                continue;
+            }
+
+            const Font::Glyph* glyph = font->GetGlyph(codepoint);
+            if (!glyph) {
+                continue;
+            }
+            if (previous) {
+                pen.x += font->GetKerning(previous, codepoint) * size;
+            }
+            previous = codepoint;
+
+            // 空格等空白字符只前进
+            if (glyph->Size.x > 0.0f) {
+                const glm::vec2 glyphSize = {glyph->Size.x * size, glyph->Size.y * size};
+                const glm::vec3 center = {pen.x + glyph->Offset.x * size + glyphSize.x * 0.5f,
+                                          pen.y + glyph->Offset.y * size + glyphSize.y * 0.5f, position.z};
+                DrawGlyph(center, glyphSize, color, atlas, glyph->UVMin, glyph->UVMax);
+            }
+            pen.x += glyph->Advance * size;
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Shapes ///////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    // 形状也是一个矩形：纹理坐标是以单位长度计量、以中心为原点的局部坐标，四个角的绝对值就是半边长，
+    // shader据此计算圆角矩形的有向距离；圆角矩形的单位长度是圆角半径，直角矩形是最短的半边
+    // rotation为弧度，radius和thickness为世界单位，thickness为0时填充
+    static void DrawShape(const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color,
+                          float radius, float thickness) {
+        const float minHalf = std::min(size.x, size.y) * 0.5f;
+        if (minHalf <= 0.0f || CullQuad(position, size, rotation)) {
+            return;
+        }
+        // 和字形一样，工作线程上计入自己的上下文
+        if (t_ThreadContext) {
+            t_ThreadContext->Shapes++;
+        } else {
+            s_Data->Stats.Shapes++;
+        }
+
+        radius = std::clamp(radius, 0.0f, minHalf);
+        const bool rounded = radius > 0.0f;
+        const glm::vec2 extent = size * 0.5f / (rounded ? radius : minHalf);
+        // 描边宽度达到最短半边时和填充没有区别
+        const float outline = thickness > 0.0f && thickness < minHalf ? thickness / minHalf : 0.0f;
+        const float texIndex = (rounded ? RoundedShapeTexIndex : BoxShapeTexIndex) - 0.5f * outline;
+        const glm::vec2 texCoords[4] = {{-extent.x, -extent.y}, {extent.x, -extent.y}, {extent.x, extent.y}, {-extent.x, extent.y}};
+
+        if (t_ThreadContext) {
+            RecordThreadQuad(*t_ThreadContext, position, size, rotation, color, 1.0f, QueuedTextureKind::Shape, 0, texIndex, texCoords);
+            return;
+        }
+        if (s_Data->SortedSubmission) {
+            QueuedQuad& quad = EnqueueQuad(position, size, rotation, color, 1.0f);
+            quad.UVMin = texCoords[0];
+            quad.UVMax = texCoords[2];
+            quad.Kind = QueuedTextureKind::Shape;
+            quad.ShapeTexIndex = texIndex;
+            // 边缘是抗锯齿的，总是需要混合
+            quad.Translucent = true;
+            return;
+        }
+
+        if (IsBatchFull()) {
+            NextBatch(FlushReason::BatchFull);
+        }
+
+        SubmitQuad(position, size, rotation, color, texIndex, 1.0f, texCoords);
+    }
+
+    void Renderer2D::DrawCircle(const glm::vec2 &center, float radius, const glm::vec4 &color, float thickness) {
+        DrawCircle({center.x, center.y, 0.0f}, radius, color, thickness);
+    }
+
+    void Renderer2D::DrawCircle(const glm::vec3 &center, float radius, const glm::vec4 &color, float thickness) {
+        HZ_PROFILE_FUNCTION();
+
+        // 正方形里圆角半径等于半边长就是圆
+        DrawShape(center, {radius * 2.0f, radius * 2.0f}, 0.0f, color, radius, thickness);
+    }
+
+    void Renderer2D::DrawLine(const glm::vec2 &p0, const glm::vec2 &p1, float width, const glm::vec4 &color, LineCap cap) {
+        DrawLine({p0.x, p0.y, 0.0f}, {p1.x, p1.y, 0.0f}, width, color, cap);
+    }
+
+    void Renderer2D::DrawLine(const glm::vec3 &p0, const glm::vec3 &p1, float width, const glm::vec4 &color, LineCap cap) {
+        HZ_PROFILE_FUNCTION();
+
+        // 沿线段方向旋转的矩形，Square和Round两端各延长半个线宽
+        const glm::vec2 delta = {p1.x - p0.x, p1.y - p0.y};
+        const float length = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+        const float extension = cap == LineCap::Butt ? 0.0f : width;
+        const glm::vec3 center = {(p0.x + p1.x) * 0.5f, (p0.y + p1.y) * 0.5f, p0.z};
+        const float rotation = length > 0.0f ? std::atan2(delta.y, delta.x) : 0.0f;
+        DrawShape(center, {length + extension, width}, rotation, color, cap == LineCap::Round ? width * 0.5f : 0.0f, 0.0f);
+    }
+
+    void Renderer2D::DrawRoundedRect(const glm::vec2 &position, const glm::vec2 &size, float cornerRadius, const glm::vec4 &color, float thickness) {
+        DrawRoundedRect({position.x, position.y, 0.0f}, size, 0.0f, cornerRadius, color, thickness);
+    }
+
+    void Renderer2D::DrawRoundedRect(const glm::vec3 &position, const glm::vec2 &size, float rotation, float cornerRadius,
+                                     const glm::vec4 &color, float thickness) {
+        HZ_PROFILE_FUNCTION();
+
+        DrawShape(position, size, glm::radians(rotation), color, cornerRadius, thickness);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Polygons /////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    // 求顶点的包围盒，包围盒和可见区域不相交时返回true
+    static bool CullPolygon(const glm::vec2* positions, uint32_t count, glm::vec2& min, glm::vec2& max) {
+        min = max = positions[0];
+        for (uint32_t i = 1; i < count; i++) {
+            min.x = std::min(min.x, positions[i].x);
+            min.y = std::min(min.y, positions[i].y);
+            max.x = std::max(max.x, positions[i].x);
+            max.y = std::max(max.y, positions[i].y);
+        }
+        if (!s_Data->Culling) {
+            return false;
+        }
+        return max.x < s_Data->ViewMin.x || min.x > s_Data->ViewMax.x || max.y < s_Data->ViewMin.y || min.y > s_Data->ViewMax.y;
+    }
+
+    // 多边形的顶点逐个写入，texCoords为空时纹理坐标为0
+    static void WritePolygonVertices(QuadVertex* vertex, const glm::vec2* positions, const glm::vec2* texCoords, uint32_t count,
+                                     float z, const glm::vec4& color, float texIndex, float tilingFactor) {
+        for (uint32_t i = 0; i < count; i++) {
+            vertex->Position = {positions[i].x, positions[i].y, z};
+            vertex->Color = color;
+            vertex->TexCoord = texCoords ? texCoords[i] : glm::vec2(0.0f);
+            vertex->TexIndex = texIndex;
+            vertex->TilingFactor = tilingFactor;
+            vertex++;
+        }
+    }
+
+    static void WritePolygonVertices(PackedQuadVertex* vertex, const glm::vec2* positions, const glm::vec2* texCoords, uint32_t count,
+                                     float z, const glm::vec4& color, float texIndex, float tilingFactor) {
+        const uint32_t depthTexIndex = glm::packHalf2x16({z, texIndex});
+        const uint32_t packedColor = glm::packUnorm4x8(color);
+        for (uint32_t i = 0; i < count; i++) {
+            vertex->Position = positions[i];
+            vertex->DepthTexIndex = depthTexIndex;
+            vertex->TexCoord = texCoords ? glm::packHalf2x16(texCoords[i] * tilingFactor) : 0;
+            vertex->Color = packedColor;
+            vertex++;
+        }
+    }
+
+    // 把一组三角形写进当前批次的顶点流，索引相对于positions；texture为空时是纯色
+    // 批次容量按矩形折算：顶点每4个、索引每6个算一个矩形，取两者中大的，这样矩形和多边形混在一起时顶点和索引都不会超出
+    static void SubmitTriangles(const glm::vec2* positions, const glm::vec2* texCoords, uint32_t vertexCount,
+                                const uint32_t* indices, uint32_t indexCount, float depth, const glm::vec4& color,
+                                const Ref<Texture2D>& texture, float tilingFactor) {
+        const uint32_t charge = std::max((indexCount + 5) / 6, (vertexCount + 3) / 4) * 6;
+        if (charge > s_Data->MaxIndices) {
+            HZ_CORE_ERROR("Renderer2D: {0} vertices and {1} indices do not fit in one batch", vertexCount, indexCount);
+            return;
+        }
+        if (s_Data->QuadIndexCount + charge > s_Data->MaxIndices) {
+            NextBatch(FlushReason::BatchFull);
+        }
+        const float texIndex = texture ? GetTextureIndex(texture) : NoTextureIndex;
+
+        // 之前写入的矩形先按矩形的模式补上索引，多边形的索引接在后面
+        SyncPolygonIndices();
+        s_Data->PolygonBatch = true;
+        const uint32_t baseVertex = s_Data->PolygonSyncVertex;
+        if (s_Data->PackedVertices) {
+            PackedQuadVertex* vertex = (PackedQuadVertex*)s_Data->QuadVertexBufferPtr;
+            WritePolygonVertices(vertex, positions, texCoords, vertexCount, depth, color, texIndex, tilingFactor);
+            s_Data->QuadVertexBufferPtr = (uint8_t*)(vertex + vertexCount);
+        } else {
+            QuadVertex* vertex = (QuadVertex*)s_Data->QuadVertexBufferPtr;
+            WritePolygonVertices(vertex, positions, texCoords, vertexCount, depth, color, texIndex, tilingFactor);
+            s_Data->QuadVertexBufferPtr = (uint8_t*)(vertex + vertexCount);
+        }
+        for (uint32_t i = 0; i < indexCount; i++) {
+            HZ_CORE_ASSERT(indices[i] < vertexCount, "Triangle index out of range!");
+            s_Data->PolygonIndices.push_back(baseVertex + indices[i]);
+        }
+        s_Data->PolygonSyncVertex = baseVertex + vertexCount;
+        s_Data->QuadIndexCount += charge;
+
+        s_Data->Stats.Polygons++;
+        s_Data->Stats.PolygonTriangles += indexCount / 3;
+    }
+
+    // 三角化的结果放在复用的临时数组里，失败时保留已经切下的三角形
+    static const std::vector<uint32_t>& TriangulatePolygon(const glm::vec2* outline, uint32_t count) {
+        auto& indices = s_Data->TriangulatedIndices;
+        indices.clear();
+        if (!Triangulator::Triangulate(outline, count, indices)) {
+            HZ_CORE_WARN("Renderer2D: polygon with {0} vertices is degenerate or self-intersecting, {1} triangles drawn",
+                         count, indices.size() / 3);
+        }
+        return indices;
+    }
+
+    void Renderer2D::DrawTriangles(const glm::vec2 *positions, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount,
+                                   float depth, const glm::vec4 &color) {
+        HZ_PROFILE_FUNCTION();
+        HZ_CORE_ASSERT(!t_ThreadContext, "Triangles can only be drawn on the render thread!");
+        HZ_CORE_ASSERT(indexCount % 3 == 0, "Index count must be a multiple of 3!");
+
+        glm::vec2 min, max;
+        if (vertexCount == 0 || indexCount < 3 || CullPolygon(positions, vertexCount, min, max)) {
+            return;
+        }
+        SubmitTriangles(positions, nullptr, vertexCount, indices, indexCount, depth, color, nullptr, 1.0f);
+    }
+
+    void Renderer2D::DrawTriangles(const glm::vec2 *positions, const glm::vec2 *texCoords, uint32_t vertexCount, const uint32_t *indices,
+                                   uint32_t indexCount, float depth, const Ref<Texture2D> &texture, float tilingFactor,
+                                   const glm::vec4 &tintColor) {
+        HZ_PROFILE_FUNCTION();
+        HZ_CORE_ASSERT(!t_ThreadContext, "Triangles can only be drawn on the render thread!");
+        HZ_CORE_ASSERT(indexCount % 3 == 0, "Index count must be a multiple of 3!");
+
+        glm::vec2 min, max;
+        if (vertexCount == 0 || indexCount < 3 || CullPolygon(positions, vertexCount, min, max)) {
+            return;
+        }
+        SubmitTriangles(positions, texCoords, vertexCount, indices, indexCount, depth, tintColor, texture, tilingFactor);
+    }
+
+    void Renderer2D::DrawPolygon(const glm::vec2 *outline, uint32_t count, float depth, const glm::vec4 &color) {
+        HZ_PROFILE_FUNCTION();
+        HZ_CORE_ASSERT(!t_ThreadContext, "Polygons can only be drawn on the render thread!");
+
+        // 先剔除，看不见的多边形不需要三角化
+        glm::vec2 min, max;
+        if (count < 3 || CullPolygon(outline, count, min, max)) {
+            return;
+        }
+        const auto& indices = TriangulatePolygon(outline, count);
+        if (!indices.empty()) {
+            SubmitTriangles(outline, nullptr, count, indices.data(), (uint32_t)indices.size(), depth, color, nullptr, 1.0f);
+        }
+    }
+
+    void Renderer2D::DrawPolygon(const glm::vec2 *outline, uint32_t count, float depth, const Ref<Texture2D> &texture,
+                                 float tilingFactor, const glm::vec4 &tintColor) {
+        HZ_PROFILE_FUNCTION();
+        HZ_CORE_ASSERT(!t_ThreadContext, "Polygons can only be drawn on the render thread!");
+
+        glm::vec2 min, max;
+        if (count < 3 || CullPolygon(outline, count, min, max)) {
+            return;
+        }
+        const auto& indices = TriangulatePolygon(outline, count);
+        if (indices.empty()) {
+            return;
+        }
+        // 纹理铺满包围盒
+        const glm::vec2 size = {std::max(max.x - min.x, 1e-6f), std::max(max.y - min.y, 1e-6f)};
+        auto& texCoords = s_Data->PolygonTexCoords;
+        texCoords.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            texCoords[i] = {(outline[i].x - min.x) / size.x, (outline[i].y - min.y) / size.y};
+        }
+        SubmitTriangles(outline, texCoords.data(), count, indices.data(), (uint32_t)indices.size(), depth, tintColor, texture, tilingFactor);
+    }
+
+    // DrawQuads里解析第i个矩形的纹理槽，相邻矩形大多使用同一张纹理，所以缓存上一次的查找结果
+    // 纹理槽用完时返回false，调用方在这里截断批次
+    static bool ResolveBatchTexture(const Renderer2D::QuadBatch& batch, uint32_t i, const Texture2D*& lastTexture, float& texIndex) {
+        if (!batch.Textures) {
+            return true;
+        }
+
+        const Ref<Texture2D>& texture = batch.Textures[i];
+        if (!texture) {
+            texIndex = NoTextureIndex;
+            lastTexture = nullptr;
+        } else if (texture.get() != lastTexture) {
+            int index = FindTextureIndex(texture);
+            if (index < 0) {
+                if (s_Data->TextureSlotIndex >= GetBatchTextureSlots() || s_Data->BatchTextureArray) {
+                    return false;
+                }
+                index = AddTexture(texture);
+            }
+            texIndex = (float)index;
+            lastTexture = texture.get();
+        }
+        return true;
+    }
+
+    // 批次模式：先用内核一次生成整段的顶点坐标，再在一个循环里写入交错的顶点，返回实际写入的个数
+    template<typename Vertex>
+    static uint32_t WriteBatchVertices(const Renderer2D::QuadBatch& batch, uint32_t offset, uint32_t count) {
+        const float* rotations = nullptr;
+        if (batch.Rotations) {
+            for (uint32_t i = 0; i < count; i++) {
+                s_Data->Rotations[i] = glm::radians(batch.Rotations[offset + i]);
+            }
+            rotations = s_Data->Rotations.data();
+        }
+
+        const float* xs = s_Data->CornerXs.data();
+        const float* ys = s_Data->CornerYs.data();
+        QuadKernel::GenerateCorners(batch.Positions + offset, batch.Sizes + offset, rotations, count,
+                                    s_Data->CornerXs.data(), s_Data->CornerYs.data());
+
+        float texIndex = NoTextureIndex;
+        if (!batch.Textures && batch.Texture) {
+            texIndex = GetTextureIndex(batch.Texture);
+        }
+        const Texture2D* lastTexture = nullptr;
+
+        Vertex* vertex = (Vertex*)s_Data->QuadVertexBufferPtr;
+        uint32_t written = 0;
+        for (; written < count; written++) {
+            const uint32_t i = offset + written;
+            if (!ResolveBatchTexture(batch, i, lastTexture, texIndex)) {
+                break;
+            }
+
+            const float z = batch.Depths ? batch.Depths[i] : batch.Depth;
+            const glm::vec4& color = batch.Colors ? batch.Colors[i] : batch.Color;
+            const float tilingFactor = batch.TilingFactors ? batch.TilingFactors[i] : batch.TilingFactor;
+
+            WriteQuadVertices(vertex, xs + written * 4, ys + written * 4, z, color, s_QuadTexCoords, texIndex, tilingFactor);
+        }
+
+        s_Data->QuadVertexBufferPtr = (uint8_t*)vertex;
+        s_Data->QuadIndexCount += written * 6;
+        return written;
+    }
+
+    // 实例化和顶点拉取模式：不需要生成顶点，直接写实例记录
+    static uint32_t WriteBatchInstances(const Renderer2D::QuadBatch& batch, uint32_t offset, uint32_t count) {
+        float texIndex = NoTextureIndex;
+        if (!batch.Textures && batch.Texture) {
+            texIndex = GetTextureIndex(batch.Texture);
+        }
+        const Texture2D* lastTexture = nullptr;
+
+        QuadInstance* instance = s_Data->QuadInstanceBufferPtr;
+        uint32_t written = 0;
+        for (; written < count; written++) {
+            const uint32_t i = offset + written;
+            if (!ResolveBatchTexture(batch, i, lastTexture, texIndex)) {
+                break;
+            }
+
+            instance->Position = {batch.Positions[i].x, batch.Positions[i].y, batch.Depths ? batch.Depths[i] : batch.Depth};
+            instance->Size = batch.Sizes[i];
+            instance->Rotation = batch.Rotations ? glm::radians(batch.Rotations[i]) : 0.0f;
+            instance->Color = batch.Colors ? batch.Colors[i] : batch.Color;
+            instance->TexRect = {0.0f, 0.0f, 1.0f, 1.0f};
+            instance->TexIndex = texIndex;
+            instance->TilingFactor = batch.TilingFactors ? batch.TilingFactors[i] : batch.TilingFactor;
+            instance++;
+        }
+
+        s_Data->QuadInstanceBufferPtr = instance;
+        s_Data->QuadInstanceCount += written;
+        return written;
+    }
+
+    void Renderer2D::DrawQuads(const QuadBatch& batch) {
+        HZ_PROFILE_FUNCTION();
+
+        HZ_CORE_ASSERT(batch.Count == 0 || (batch.Positions && batch.Sizes), "DrawQuads requires positions and sizes!");
+
+        if (t_ThreadContext || s_Data->SortedSubmission) {
+            for (uint32_t i = 0; i < batch.Count; i++) {
+                const glm::vec3 position = {batch.Positions[i], batch.Depths ? batch.Depths[i] : batch.Depth};
+                const float rotation = batch.Rotations ? glm::radians(batch.Rotations[i]) : 0.0f;
+                if (CullQuad(position, batch.Sizes[i], rotation)) {
+                    continue;
+                }
+                const glm::vec4& color = batch.Colors ? batch.Colors[i] : batch.Color;
+                const float tilingFactor = batch.TilingFactors ? batch.TilingFactors[i] : batch.TilingFactor;
+                const Ref<Texture2D>& texture = batch.Textures ? batch.Textures[i] : batch.Texture;
+                if (texture) {
+                    DeferQuad(position, batch.Sizes[i], rotation, color, tilingFactor, texture);
+                } else {
+                    DeferQuad(position, batch.Sizes[i], rotation, color, tilingFactor);
+                }
+            }
+            return;
+        }
+
+        // 不可见的矩形在生成顶点之前剔除
+        QuadBatch culled;
+        const QuadBatch& visible = CullBatch(batch, culled);
+
+        const bool instanced = UsesQuadInstances();
+
+        uint32_t offset = 0;
+        while (offset < visible.Count) {
+            if (IsBatchFull()) {
+                NextBatch(FlushReason::BatchFull);
+            }
+
+            // 当前批次剩余的空间决定这一轮最多能写多少个矩形
+            uint32_t room = instanced ? GetMaxQuadInstances() - s_Data->QuadInstanceCount
+                                      : (s_Data->MaxIndices - s_Data->QuadIndexCount) / 6;
+            uint32_t count = std::min(room, visible.Count - offset);
+
+            uint32_t written = instanced ? WriteBatchInstances(visible, offset, count)
+                             : s_Data->PackedVertices ? WriteBatchVertices<PackedQuadVertex>(visible, offset, count)
+                                                      : WriteBatchVertices<QuadVertex>(visible, offset, count);
+
+            s_Data->Stats.QuadCount += written;
+            offset += written;
+
+            // 纹理槽用完了（或者当前是纹理数组批次），剩下的矩形放到下一个批次
+            if (written < count) {
+                NextBatch(s_Data->BatchTextureArray ? FlushReason::TextureArraySwitch : FlushReason::TextureSlotsFull);
+            }
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SpriteBuffer /////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    SpriteBuffer::SpriteBuffer(uint32_t capacity, bool gpuCulling) : m_Capacity(capacity), m_GPUCulling(gpuCulling) {
+        HZ_PROFILE_FUNCTION();
+
+        m_Alive.resize(capacity, false);
+        m_VertexArray = VertexArray::Create();
+        if (m_GPUCulling) {
+            // 每个精灵一条实例记录，剔除pass按顶点读取；留下来的记录写进m_VisibleBuffers，再按实例绘制
+            m_Instances.resize(capacity);
+            m_VertexBuffer = VertexBuffer::Create(capacity * sizeof(QuadInstance));
+            m_VertexBuffer->SetLayout(GetQuadInstanceLayout(0));
+            m_VertexArray->AddVertexBuffer(m_VertexBuffer);
+
+            m_Culler = SpriteCuller::Create();
+            for (int i = 0; i < 2; i++) {
+                m_VisibleArrays[i] = VertexArray::Create();
+                m_VisibleBuffers[i] = VertexBuffer::Create(capacity * sizeof(QuadInstance));
+                m_VisibleBuffers[i]->SetLayout(GetQuadInstanceLayout(1));
+                m_VisibleArrays[i]->AddVertexBuffer(m_VisibleBuffers[i]);
+                m_VisibleArrays[i]->SetIndexBuffer(s_Data->QuadIndexBuffer);
+            }
+            return;
+        }
+
+        m_Vertices.resize((size_t)capacity * 4);
+        m_VertexBuffer = VertexBuffer::Create(capacity * 4 * sizeof(QuadVertex));
+        m_VertexBuffer->SetLayout(GetQuadVertexLayout());
+        m_VertexArray->AddVertexBuffer(m_VertexBuffer);
+        Ref<IndexBuffer> indexBuffer = CreateQuadIndexBuffer(capacity);
+        m_VertexArray->SetIndexBuffer(indexBuffer);
+    }
+
+    SpriteBuffer::~SpriteBuffer() = default;
+
+    SpriteBuffer::Handle SpriteBuffer::Add(const Sprite &sprite) {
+        Handle handle;
+        if (!m_FreeList.empty()) {
+            handle = m_FreeList.back();
+            m_FreeList.pop_back();
+        } else if (m_Used < m_Capacity) {
+            handle = m_Used++;
+        } else {
+            HZ_CORE_ERROR("SpriteBuffer is full ({0} sprites)", m_Capacity);
+            return InvalidHandle;
+        }
+
+        float texIndex;
+        if (!GetTextureIndex(sprite.Texture, texIndex)) {
+            m_FreeList.push_back(handle);
+            return InvalidHandle;
+        }
+
+        m_Count++;
+        m_Alive[handle] = true;
+        WriteSprite(handle, sprite, texIndex);
+        return handle;
+    }
+
+    bool SpriteBuffer::Set(Handle handle, const Sprite &sprite) {
+        HZ_CORE_ASSERT(handle < m_Used && m_Alive[handle], "Invalid sprite handle!");
+        if (handle >= m_Used || !m_Alive[handle]) {
+            return false;
+        }
+
+        // 纹理槽用完时和Add一样失败，精灵保持原样
+        float texIndex;
+        if (!GetTextureIndex(sprite.Texture, texIndex)) {
+            return false;
+        }
+        WriteSprite(handle, sprite, texIndex);
+        return true;
+    }
+
+    void SpriteBuffer::Remove(Handle handle) {
+        HZ_CORE_ASSERT(handle < m_Used, "Invalid sprite handle!");
+        HZ_CORE_ASSERT(handle >= m_Used || m_Alive[handle], "Sprite was already removed!");
+        // 重复删除会让同一个下标两次进入空闲表，之后两次Add拿到同一个位置
+        if (handle >= m_Used || !m_Alive[handle]) {
+            return;
+        }
+        m_Alive[handle] = false;
+        // 四个顶点重合，光栅化时不产生任何像素；GPU剔除时尺寸为0的记录在剔除pass里丢掉
+        if (m_GPUCulling) {
+            memset(&m_Instances[handle], 0, sizeof(QuadInstance));
+        } else {
+            memset(&m_Vertices[(size_t)handle * 4], 0, 4 * sizeof(QuadVertex));
+        }
+        MarkDirty(handle);
+        m_FreeList.push_back(handle);
+        m_Count--;
+    }
+
+    // 清空用到的记录并标记为脏，之后重新Add的精灵少于原来时，GPU上不会留下旧的矩形
+    void SpriteBuffer::Clear() {
+        if (m_Used) {
+            if (m_GPUCulling) {
+                memset(m_Instances.data(), 0, (size_t)m_Used * sizeof(QuadInstance));
+            } else {
+                memset(m_Vertices.data(), 0, (size_t)m_Used * 4 * sizeof(QuadVertex));
+            }
+            m_DirtyRanges.clear();
+            m_DirtyRanges.push_back({0, m_Used});
+        }
+        std::fill(m_Alive.begin(), m_Alive.end(), false);
+        m_Count = 0;
+        m_Used = 0;
+        m_FreeList.clear();
+        m_Textures.clear();
+    }
+
+    // 纹理在缓冲自己的纹理表里的下标，纹理槽用完时返回false
+    bool SpriteBuffer::GetTextureIndex(const Ref<Texture2D> &texture, float &texIndex) {
+        if (!texture) {
+            texIndex = NoTextureIndex;
+            return true;
+        }
+        for (uint32_t i = 0; i < m_Textures.size(); i++) {
+            if (*m_Textures[i] == *texture) {
+                texIndex = (float)i;
+                return true;
+            }
+        }
+        // 绘制时可能开着光照，按光照变体的纹理槽数限制
+        if (m_Textures.size() >= s_Data->LitTexturesSlots) {
+            HZ_CORE_ERROR("SpriteBuffer uses more than {0} textures", s_Data->LitTexturesSlots);
+            return false;
+        }
+        texIndex = (float)m_Textures.size();
+        m_Textures.push_back(texture);
+        return true;
+    }
+
+    void SpriteBuffer::WriteSprite(Handle handle, const Sprite &sprite, float texIndex) {
+        const glm::vec2 texCoords[4] = {{sprite.UVMin.x, sprite.UVMin.y}, {sprite.UVMax.x, sprite.UVMin.y},
+                                        {sprite.UVMax.x, sprite.UVMax.y}, {sprite.UVMin.x, sprite.UVMax.y}};
+        if (m_GPUCulling) {
+            FillQuadInstance(m_Instances[handle], sprite.Position, sprite.Size, glm::radians(sprite.Rotation), sprite.Color,
+                             texCoords, texIndex, sprite.TilingFactor);
+            MarkDirty(handle);
+            return;
+        }
+
+        float xs[4], ys[4];
+        if (sprite.Rotation == 0.0f) {
+            QuadKernel::GenerateCornersAxisAligned({sprite.Position.x, sprite.Position.y}, sprite.Size, xs, ys);
+        } else {
+            QuadKernel::GenerateCorners({sprite.Position.x, sprite.Position.y}, sprite.Size, glm::radians(sprite.Rotation), xs, ys);
+        }
+
+        QuadVertex* vertex = &m_Vertices[(size_t)handle * 4];
+        WriteQuadVertices(vertex, xs, ys, sprite.Position.z, sprite.Color, texCoords, texIndex, sprite.TilingFactor);
+        MarkDirty(handle);
+    }
+
+    void SpriteBuffer::MarkDirty(Handle handle) {
+        // 连续修改（比如逐个Add）只扩展最后一个区间
+        if (!m_DirtyRanges.empty()) {
+            auto& last = m_DirtyRanges.back();
+            if (handle >= last.first && handle <= last.second) {
+                last.second = std::max(last.second, handle + 1);
+                return;
+            }
+        }
+        m_DirtyRanges.push_back({handle, handle + 1});
+    }
+
+    uint32_t SpriteBuffer::Upload() {
+        if (m_DirtyRanges.empty()) {
+            return 0;
+        }
+        HZ_PROFILE_FUNCTION();
+
+        // 间隔很小的区间合并成一次上传，多传一点数据比多一次调用便宜
+        const uint32_t mergeGap = 16;
+        std::sort(m_DirtyRanges.begin(), m_DirtyRanges.end());
+        std::vector<std::pair<uint32_t, uint32_t>> ranges;
+        for (auto& range : m_DirtyRanges) {
+            if (!ranges.empty() && range.first <= ranges.back().second + mergeGap) {
+                ranges.back().second = std::max(ranges.back().second, range.second);
+            } else {
+                ranges.push_back(range);
+            }
+        }
+        m_DirtyRanges.clear();
+
+        // 每个精灵是4个顶点或者一条实例记录
+        const uint32_t recordSize = m_GPUCulling ? sizeof(QuadInstance) : 4 * sizeof(QuadVertex);
+        const uint8_t* records = m_GPUCulling ? (const uint8_t*)m_Instances.data() : (const uint8_t*)m_Vertices.data();
+        uint32_t bytes = 0;
+        for (auto& [begin, end] : ranges) {
+            const uint32_t offset = begin * recordSize;
+            const uint32_t size = (end - begin) * recordSize;
+            m_VertexBuffer->SetSubData(records + offset, size, offset);
+            bytes += size;
+        }
+        return bytes;
+    }
+
+    // GPU剔除时可见区域每边向外扩展的比例（相对可见区域的宽高），掩盖剔除结果晚一帧
+    static const float GPUCullPadding = 0.25f;
+
+    uint32_t SpriteBuffer::Cull(const glm::vec2& viewMin, const glm::vec2& viewMax) {
+        HZ_PROFILE_FUNCTION();
+
+        // 只读取已经完成的查询，先读旧的再读新的，两个都完成时用新的
+        for (int i : {m_LastCull ^ 1, m_LastCull}) {
+            uint32_t written = 0;
+            if (m_CullPending[i] && m_Culler->PollResult(i, written)) {
+                m_CullPending[i] = false;
+                m_Visible = i;
+                m_VisibleCount = written;
+            }
+        }
+
+        // 剔除进不在绘制的那个缓冲；GPU落后超过一帧时它的结果还没读回，这一帧不再发起新的剔除
+        int target = m_Visible < 0 ? m_LastCull ^ 1 : m_Visible ^ 1;
+        if (!m_CullPending[target]) {
+            // 剔除pass遍历所有用到的下标，删掉的精灵在shader里丢掉；CPU上不碰任何一个精灵
+            glm::vec2 padding = (viewMax - viewMin) * GPUCullPadding;
+            m_Culler->Cull(target, m_VertexArray, m_Used, m_VisibleBuffers[target], viewMin - padding, viewMax + padding);
+            m_CullPending[target] = true;
+            m_LastCull = target;
+        }
+
+        // 第一次绘制还没有完成的结果，只能等这一次的剔除
+        if (m_Visible < 0) {
+            m_VisibleCount = m_Culler->WaitResult(m_LastCull);
+            m_CullPending[m_LastCull] = false;
+            m_Visible = m_LastCull;
+        }
+        return m_VisibleCount;
+    }
+
+    Ref<SpriteBuffer> Renderer2D::CreateSpriteBuffer(uint32_t capacity, bool gpuCulling) {
+        return CreateRef<SpriteBuffer>(capacity, gpuCulling);
+    }
+
+    void Renderer2D::DrawSpriteBuffer(const Ref<SpriteBuffer> &buffer) {
+        HZ_PROFILE_FUNCTION();
+
+        // 先画掉已经提交的矩形，保持提交顺序
+        if (s_Data->QuadIndexCount || s_Data->QuadInstanceCount) {
+            NextBatch(FlushReason::Explicit);
+        }
+
+        s_Data->Stats.RetainedUploadBytes += buffer->Upload();
+        if (buffer->m_Count == 0) {
+            return;
+        }
+
+        uint32_t count = buffer->m_Count;
+        if (buffer->m_GPUCulling) {
+            count = buffer->Cull(s_Data->ViewMin, s_Data->ViewMax);
+            s_Data->Stats.GPUCulledQuads += buffer->m_Count - std::min(count, buffer->m_Count);
+            if (count == 0) {
+                return;
+            }
+        }
+
+        // 没用到的槽位也绑定白色纹理，理由同Flush
+        for (uint32_t i = 0; i < s_Data->MaxTexturesSlots; i++) {
+            const Ref<Texture2D>& texture = i < buffer->m_Textures.size() ? buffer->m_Textures[i] : s_Data->WhiteTexture;
+            texture->Bind(i);
+        }
+        if (buffer->m_GPUCulling) {
+            BindQuadShader(s_Data->InstancedTextureShader);
+            const Ref<VertexArray>& visible = buffer->m_VisibleArrays[buffer->m_Visible];
+            visible->Bind();
+            RenderCommand::DrawIndexedInstanced(visible, 6, count);
+        } else {
+            BindQuadShader(s_Data->TextureShader);
+            buffer->m_VertexArray->Bind();
+            RenderCommand::DrawIndexed(buffer->m_VertexArray, buffer->m_Used * 6);
+        }
+
+        s_Data->Stats.DrawCalls++;
+        s_Data->Stats.QuadCount += count;
+        s_Data->Stats.RetainedQuads += count;
+    }
+
+    void Renderer2D::DrawTilemap(const Ref<Tilemap> &tilemap) {
+        HZ_PROFILE_FUNCTION();
+
+        // 先画掉已经提交的矩形，保持提交顺序
+        if (s_Data->QuadIndexCount || s_Data->QuadInstanceCount) {
+            NextBatch(FlushReason::Explicit);
+        }
+
+        // 只遍历和可见区域相交的块，不管剔除开关，否则大地图的开销会和地图大小成正比
+        const float chunkWorldSize = Tilemap::ChunkSize * tilemap->m_TileSize;
+        const glm::vec3& origin = tilemap->m_Position;
+        auto toChunk = [&](float world, float originCoord, uint32_t count) {
+            float chunk = std::floor((world - originCoord) / chunkWorldSize);
+            return (int64_t)std::clamp(chunk, -1.0f, (float)count);
+        };
+        const int64_t x0 = std::max<int64_t>(toChunk(s_Data->ViewMin.x, origin.x, tilemap->m_ChunkColumns), 0);
+        const int64_t y0 = std::max<int64_t>(toChunk(s_Data->ViewMin.y, origin.y, tilemap->m_ChunkRows), 0);
+        // 先转成有符号数再减1，0行或0列的地图得到-1，下面的范围检查直接返回
+        const int64_t x1 = std::min<int64_t>(toChunk(s_Data->ViewMax.x, origin.x, tilemap->m_ChunkColumns), (int64_t)tilemap->m_ChunkColumns - 1);
+        const int64_t y1 = std::min<int64_t>(toChunk(s_Data->ViewMax.y, origin.y, tilemap->m_ChunkRows), (int64_t)tilemap->m_ChunkRows - 1);
+
+        tilemap->m_UploadBytes = 0;
+        if (x0 > x1 || y0 > y1) {
+            return;
+        }
+
+        auto& shader = s_Data->TilemapShader;
+        shader->Bind();
+        shader->SetFloat("u_Depth", origin.z);
+        shader->SetFloat("u_ChunkSize", (float)Tilemap::ChunkSize);
+        shader->SetFloat4("u_TilesetGrid", {(float)tilemap->m_TilesetColumns, (float)tilemap->m_TilesetRows, 0.0f, 0.0f});
+        tilemap->m_Tileset->Bind(0);
+        s_Data->TilemapVertexArray->Bind();
+
+        for (int64_t y = y0; y <= y1; y++) {
+            for (int64_t x = x0; x <= x1; x++) {
+                Tilemap::Chunk& chunk = tilemap->m_Chunks[y * tilemap->m_ChunkColumns + x];
+                if (!tilemap->PrepareChunk(chunk)) {
+                    continue;
+                }
+                chunk.Indices->Bind(1);
+                shader->SetFloat4("u_ChunkRect", {origin.x + x * chunkWorldSize, origin.y + y * chunkWorldSize, chunkWorldSize, chunkWorldSize});
+                RenderCommand::DrawIndexed(s_Data->TilemapVertexArray, 6);
+
+                s_Data->Stats.DrawCalls++;
+                s_Data->Stats.TilemapChunks++;
+            }
+        }
+        s_Data->Stats.TilemapUploadBytes += tilemap->m_UploadBytes;
     }
 
     void Renderer2D::ResetStats() {
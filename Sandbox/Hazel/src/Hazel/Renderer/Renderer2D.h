@@ -2,9 +2,99 @@
 
 #include "OrthographicCamera.h"
 #include "Hazel/Renderer/Texture.h"
+#include "Hazel/Renderer/TextureAtlas.h"
+#include "Hazel/Renderer/TextureArrayPool.h"
+#include "Hazel/Renderer/SubTexture2D.h"
+#include "Hazel/Renderer/Font.h"
+#include "Hazel/Renderer/Tilemap.h"
+#include "Hazel/Renderer/LightGrid.h"
+
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace Hazel {
 
+    class VertexArray;
+    class VertexBuffer;
+    struct QuadVertex;
+    struct QuadInstance;
+    class SpriteCuller;
+
+    // 常驻GPU的矩形缓冲：顶点一直保存在自己的顶点缓冲里，修改矩形时只上传变化的区间，绘制时一次draw call
+    // 适合背景、关卡这种基本不变的内容；用Renderer2D::CreateSpriteBuffer创建，在场景中用Renderer2D::DrawSpriteBuffer绘制
+    // 纹理由缓冲自己持有，最多为Renderer2D开启光照时的纹理槽数量，Clear之前不会释放
+    // GPU剔除：每个精灵只保存一条实例记录，绘制时先在GPU上按可见区域剔除，留下的记录紧凑地写进另一个缓冲再按实例绘制，
+    // 每帧CPU上的开销和精灵数量无关，适合几十万个精灵的大场景；不受Renderer2D::SetCulling影响
+    // 剔除结果不等GPU：两个输出缓冲轮流剔除，绘制最近一次已经完成的结果，所以画面（包括精灵的修改）通常晚一帧，
+    // 剔除时可见区域每边向外扩展一些，镜头移动时边缘不会缺精灵
+    class SpriteBuffer {
+    public:
+        struct Sprite
+        {
+            glm::vec3 Position = glm::vec3(0.0f);
+            glm::vec2 Size = glm::vec2(1.0f);
+            float Rotation = 0.0f; // 角度
+            glm::vec4 Color = glm::vec4(1.0f);
+            Ref<Texture2D> Texture; // 为空时为纯色
+            float TilingFactor = 1.0f;
+            glm::vec2 UVMin = glm::vec2(0.0f);
+            glm::vec2 UVMax = glm::vec2(1.0f);
+        };
+
+        using Handle = uint32_t;
+        static const Handle InvalidHandle = 0xffffffff;
+
+        explicit SpriteBuffer(uint32_t capacity, bool gpuCulling = false);
+        ~SpriteBuffer();
+
+        // 缓冲已满或者纹理超过纹理槽数量时返回InvalidHandle
+        Handle Add(const Sprite& sprite);
+        // 纹理超过纹理槽数量时返回false，精灵保持不变
+        bool Set(Handle handle, const Sprite& sprite);
+        void Remove(Handle handle);
+        // 删除所有精灵并清空GPU上的记录，纹理表也一起释放
+        void Clear();
+
+        uint32_t GetCount() const { return m_Count; }
+        uint32_t GetCapacity() const { return m_Capacity; }
+        bool IsGPUCulling() const { return m_GPUCulling; }
+
+    private:
+        friend class Renderer2D;
+
+        bool GetTextureIndex(const Ref<Texture2D>& texture, float& texIndex);
+        // texIndex为GetTextureIndex得到的纹理下标
+        void WriteSprite(Handle handle, const Sprite& sprite, float texIndex);
+        void MarkDirty(Handle handle);
+        // 上传所有脏区间，返回上传的字节数
+        uint32_t Upload();
+        // GPU剔除：发起这一帧的剔除，返回最近一次完成的结果里的记录数，结果在m_VisibleArrays[m_Visible]
+        uint32_t Cull(const glm::vec2& viewMin, const glm::vec2& viewMax);
+
+    private:
+        uint32_t m_Capacity;
+        uint32_t m_Count = 0;    // 有效的矩形数
+        uint32_t m_Used = 0;     // 用到的最大下标+1，绘制这么多个矩形，删掉的矩形是退化的
+        bool m_GPUCulling;
+        std::vector<QuadVertex> m_Vertices;     // 每个精灵4个顶点
+        std::vector<QuadInstance> m_Instances;  // GPU剔除时每个精灵一条实例记录
+        std::vector<Handle> m_FreeList;
+        std::vector<bool> m_Alive; // 每个下标是否是有效的精灵，防止重复删除
+        std::vector<Ref<Texture2D>> m_Textures;
+        std::vector<std::pair<uint32_t, uint32_t>> m_DirtyRanges; // [begin, end)，以矩形为单位
+        Ref<VertexArray> m_VertexArray;
+        Ref<VertexBuffer> m_VertexBuffer;
+        // GPU剔除：两个输出缓冲按实例读取，轮流作为剔除的目标
+        Ref<SpriteCuller> m_Culler;
+        Ref<VertexArray> m_VisibleArrays[2];
+        Ref<VertexBuffer> m_VisibleBuffers[2];
+        bool m_CullPending[2] = {false, false}; // 已经发起、结果还没读回的剔除
+        int m_LastCull = 1;                     // 最近一次发起剔除的输出缓冲
+        int m_Visible = -1;                     // 最近一次完成的剔除结果，-1为还没有
+        uint32_t m_VisibleCount = 0;
+    };
+
     class Renderer2D {
     public:
         static void Init();
@@ -14,6 +104,62 @@ namespace Hazel {
         static void EndScene();
         static void Flush();
 
+        // Batched：每个矩形在CPU上展开成4个顶点（160字节）；Instanced：每个矩形只上传一条64字节的实例记录，由vertex shader展开
+        // VertexPulling：实例记录放进纹理缓冲，vertex shader按gl_VertexID读取，glDrawArrays绘制，不使用索引缓冲，
+        // 批次大小只受GL_MAX_TEXTURE_BUFFER_SIZE限制
+        enum class QuadRenderMode {
+            Batched = 0, Instanced = 1, VertexPulling = 2
+        };
+        static void SetQuadRenderMode(QuadRenderMode mode);
+        static QuadRenderMode GetQuadRenderMode();
+
+        // 流式上传：Batched模式的顶点直接写进多区域的映射缓冲（支持时为持久映射），由fence保证不覆盖GPU正在读的区域
+        static void SetStreamingUpload(bool enabled);
+        static bool IsStreamingUpload();
+        static bool IsStreamingPersistent();
+
+        // 压缩顶点格式：Batched模式每个顶点20字节（默认40字节），深度、纹理索引和纹理坐标为半精度，颜色为8位
+        static void SetPackedVertices(bool enabled);
+        static bool IsPackedVertices();
+
+        // 排序提交：DrawQuad只把矩形记进队列，EndScene时按排序键排好再合并成批次，提交顺序不再影响批次数量
+        // 排序键从高到低为：层、是否半透明、深度、纹理；每一层先画不透明pass（由近到远，写入深度，被挡住的部分不再着色），
+        // 再画半透明pass（由远到近，不写深度，后画的矩形不会被前面的半透明矩形挡住）
+        // 带alpha通道的纹理或者颜色alpha小于1的矩形按半透明处理；同一层同一深度的半透明矩形不保证提交顺序
+        static void SetSortedSubmission(bool enabled);
+        static bool IsSortedSubmission();
+        // 之后提交的矩形所在的层，层号小的先画，只对排序提交有效，BeginScene时重置为0
+        static void SetSortLayer(uint8_t layer);
+
+        // 视锥剔除：BeginScene时由相机的view-projection矩阵算出世界空间的可见区域，DrawQuad/DrawQuads在生成顶点之前
+        // 丢弃包围盒完全在区域外的矩形，默认开启
+        static void SetCulling(bool enabled);
+        static bool IsCulling();
+        // 当前场景的可见区域，可以用来查询SpatialHashGrid，只把可见的精灵交给DrawQuad
+        static void GetViewBounds(glm::vec2& min, glm::vec2& max);
+
+        // 遮挡剔除：可见区域划分成低分辨率的格子，不透明的遮挡物写进它完全覆盖的格子，之后提交的矩形碰到的格子
+        // 都被更靠前（z更大）的遮挡物盖住时不生成顶点。遮挡物在BeginScene时清空，默认关闭
+        // 排序提交时不透明的纯色矩形由近到远写入批次，写过的矩形自动成为后面矩形的遮挡物；
+        // 立即提交时遮挡物要先于被遮挡的矩形用AddOccluder给出
+        static void SetOcclusionCulling(bool enabled);
+        static bool IsOcclusionCulling();
+        // 轴对齐的不透明区域，position为中心；比如前景瓦片层，带纹理的矩形由调用方保证这个区域没有透明像素
+        static void AddOccluder(const glm::vec3& position, const glm::vec2& size);
+
+        // 分块光照：设置之后矩形、文字、形状、多边形和SpriteBuffer都改用带光照的shader变体，只计算片元所在瓦片的光源
+        // grid需要先按本帧的相机和视口Build；为空时关闭光照。切换时先画掉已经提交的部分
+        // 光照变体要给光源和瓦片表留两个采样器，开启光照期间每个批次少用两个纹理槽
+        static void SetLightGrid(const Ref<LightGrid>& grid);
+        static const Ref<LightGrid>& GetLightGrid();
+
+        // 多线程提交：BeginScene和EndScene之间，工作线程调用BeginThreadSubmission(index)后，本线程的DrawQuad/DrawQuads
+        // 写进自己的上下文，顶点在工作线程上生成；EndThreadSubmission之后上下文交回渲染线程
+        // EndScene在渲染线程上按index从小到大把各上下文合并进批次，结果和线程调度无关，排在渲染线程自己提交的矩形之后
+        // 每个index同一时间只能由一个线程使用；工作线程上不要调用其它Renderer2D函数，提交期间不要切换渲染模式；排序提交对工作线程不生效
+        static void BeginThreadSubmission(uint32_t index);
+        static void EndThreadSubmission();
+
         // Primitives
         static void DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color);
         static void DrawQuad(const glm::vec3& position, const glm::vec2& size, const glm::vec4& color);
@@ -23,12 +169,124 @@ namespace Hazel {
         static void DrawQuad(const glm::vec3& position, const glm::vec2& size, const Ref<Texture2D>& texture,float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
         static void DrawQuad(const glm::vec2& position, const glm::vec2& size, float rotation, const Ref<Texture2D>& texture,float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
         static void DrawQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const Ref<Texture2D>& texture,float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
+        // 只采样纹理的[uvMin, uvMax]区域，rotation为角度
+        static void DrawQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const Ref<Texture2D>& texture, const glm::vec2& uvMin, const glm::vec2& uvMax, const glm::vec4& tintColor = glm::vec4(1.0f));
+        // 纹理数组中的一层，同一个数组里的纹理在一个批次里绘制，不占用纹理槽
+        static void DrawQuad(const glm::vec2& position, const glm::vec2& size, const TextureLayer& layer, float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
+        static void DrawQuad(const glm::vec3& position, const glm::vec2& size, const TextureLayer& layer, float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
+        static void DrawQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const TextureLayer& layer, float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
+        // 图集中的图片，同一页上的图片共用一个纹理槽
+        static void DrawQuad(const glm::vec2& position, const glm::vec2& size, const TextureAtlas::Region& region, const glm::vec4& tintColor = glm::vec4(1.0f));
+        static void DrawQuad(const glm::vec3& position, const glm::vec2& size, const TextureAtlas::Region& region, const glm::vec4& tintColor = glm::vec4(1.0f));
+        static void DrawQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const TextureAtlas::Region& region, const glm::vec4& tintColor = glm::vec4(1.0f));
+        // 精灵表中的一块区域，同一张表上的区域共用一个纹理槽
+        static void DrawQuad(const glm::vec2& position, const glm::vec2& size, const Ref<SubTexture2D>& subTexture, const glm::vec4& tintColor = glm::vec4(1.0f));
+        static void DrawQuad(const glm::vec3& position, const glm::vec2& size, const Ref<SubTexture2D>& subTexture, const glm::vec4& tintColor = glm::vec4(1.0f));
+        static void DrawQuad(const glm::vec2& position, const glm::vec2& size, float rotation, const Ref<SubTexture2D>& subTexture, const glm::vec4& tintColor = glm::vec4(1.0f));
+        static void DrawQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const Ref<SubTexture2D>& subTexture, const glm::vec4& tintColor = glm::vec4(1.0f));
+
+        // 文字：position为第一行基线的起点，size为字号（一行的高度，世界单位），'\n'换行
+        // 字形是按距离场采样的矩形，和精灵在同一个批次里，也参与剔除、排序提交和多线程提交
+        static void DrawString(const std::string& text, const Ref<Font>& font, const glm::vec2& position, float size, const glm::vec4& color = glm::vec4(1.0f));
+        static void DrawString(const std::string& text, const Ref<Font>& font, const glm::vec3& position, float size, const glm::vec4& color = glm::vec4(1.0f));
+
+        // 形状：在外接矩形里按有向距离场计算覆盖率，边缘抗锯齿；本身就是一个纯色矩形，和其它矩形混在同一个批次里
+        // thickness为描边宽度（世界单位），0为填充；形状总是按半透明处理
+        static void DrawCircle(const glm::vec2& center, float radius, const glm::vec4& color, float thickness = 0.0f);
+        static void DrawCircle(const glm::vec3& center, float radius, const glm::vec4& color, float thickness = 0.0f);
+        // 线段的端点样式：Butt在端点截断，Square和Round向外延长半个线宽，Round为半圆
+        enum class LineCap {
+            Butt = 0, Square = 1, Round = 2
+        };
+        // 深度取p0.z
+        static void DrawLine(const glm::vec2& p0, const glm::vec2& p1, float width, const glm::vec4& color, LineCap cap = LineCap::Round);
+        static void DrawLine(const glm::vec3& p0, const glm::vec3& p1, float width, const glm::vec4& color, LineCap cap = LineCap::Round);
+        // cornerRadius超过最短半边时按最短半边处理，为0时是直角矩形；rotation为角度
+        static void DrawRoundedRect(const glm::vec2& position, const glm::vec2& size, float cornerRadius, const glm::vec4& color, float thickness = 0.0f);
+        static void DrawRoundedRect(const glm::vec3& position, const glm::vec2& size, float rotation, float cornerRadius, const glm::vec4& color, float thickness = 0.0f);
+
+        // 任意三角形：顶点写进和矩形相同的顶点流，批次里有多边形时改用动态生成的索引，和矩形仍然是同一次draw call
+        // 实例化和顶点拉取模式下多边形在同一个批次里多画一次；一次提交的顶点和索引不能超过一个批次的容量
+        // 只能在渲染线程上调用，也不参与排序提交，总是立即写入当前批次
+        // indices相对于positions，每3个一个三角形；depth为所有顶点的z
+        static void DrawTriangles(const glm::vec2* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                                  float depth, const glm::vec4& color);
+        static void DrawTriangles(const glm::vec2* positions, const glm::vec2* texCoords, uint32_t vertexCount, const uint32_t* indices,
+                                  uint32_t indexCount, float depth, const Ref<Texture2D>& texture, float tilingFactor = 1.0f,
+                                  const glm::vec4& tintColor = glm::vec4(1.0f));
+        // outline为简单多边形的轮廓，凸凹都可以，不能自交，由Triangulator三角化；带纹理时纹理铺满包围盒
+        static void DrawPolygon(const glm::vec2* outline, uint32_t count, float depth, const glm::vec4& color);
+        static void DrawPolygon(const glm::vec2* outline, uint32_t count, float depth, const Ref<Texture2D>& texture,
+                                float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
+
+        // 批量提交，数据按SoA布局传入，每个数组长度均为Count
+        // Positions和Sizes必须提供，其余数组为空时统一使用对应的单值
+        struct QuadBatch
+        {
+            uint32_t Count = 0;
+            const glm::vec2* Positions = nullptr;
+            const glm::vec2* Sizes = nullptr;
+            const float* Depths = nullptr;
+            float Depth = 0.0f;
+            const float* Rotations = nullptr; // 角度，为空时按未旋转处理
+            const glm::vec4* Colors = nullptr;
+            glm::vec4 Color = glm::vec4(1.0f);
+            const Ref<Texture2D>* Textures = nullptr; // 为空时使用Texture，Texture也为空则使用白色纹理
+            Ref<Texture2D> Texture;
+            const float* TilingFactors = nullptr;
+            float TilingFactor = 1.0f;
+        };
+        static void DrawQuads(const QuadBatch& batch);
+
+        // 常驻矩形缓冲：capacity为最多容纳的矩形数；绘制时先画掉当前批次，保持和前面提交的矩形之间的顺序
+        // 排序提交和工作线程提交的矩形在EndScene时才绘制，会排在所有常驻缓冲之后
+        // gpuCulling见SpriteBuffer，绘制的是上一次已经完成的剔除结果，只有第一次绘制会等剔除pass和之前的所有命令执行完
+        static Ref<SpriteBuffer> CreateSpriteBuffer(uint32_t capacity, bool gpuCulling = false);
+        static void DrawSpriteBuffer(const Ref<SpriteBuffer>& buffer);
+
+        // 瓦片地图：每个和可见区域相交的非空块一次draw call，块的纹理在这里创建和更新；和常驻缓冲一样先画掉当前批次
+        static void DrawTilemap(const Ref<Tilemap>& tilemap);
     
         // stats
         struct Statistics
         {
             uint32_t DrawCalls = 0;
             uint32_t QuadCount = 0;
+            uint32_t CulledQuads = 0; // 被视锥剔除、没有生成顶点的矩形
+            uint32_t OccludedQuads = 0; // 被遮挡剔除的矩形
+            uint32_t TextGlyphs = 0;  // DrawString提交的字形，已经算在QuadCount里
+            uint32_t Shapes = 0;      // 圆、线段和圆角矩形，同样已经算在QuadCount里
+            // DrawPolygon和DrawTriangles提交的多边形和三角形，不算在QuadCount里
+            uint32_t Polygons = 0;
+            uint32_t PolygonTriangles = 0;
+            // 按原因统计的批次提交次数：顶点/实例缓冲写满、纹理槽用完、EndScene或切换状态、纹理数组切换
+            uint32_t BatchFullFlushes = 0;
+            uint32_t TextureSlotFlushes = 0;
+            uint32_t ExplicitFlushes = 0;
+            uint32_t TextureArrayFlushes = 0; // 纹理数组和纹理槽之间切换，或者换了一个纹理数组
+            // 流式上传时CPU等待GPU的次数、总时间(ms)以及orphan缓冲的次数
+            uint32_t StreamFenceWaits = 0;
+            float StreamStallTime = 0.0f;
+            uint32_t StreamOrphans = 0;
+            // 排序提交的矩形数，以及排序前后相邻矩形之间切换纹理的次数
+            uint32_t SortedQuads = 0;
+            uint32_t UnsortedStateChanges = 0;
+            uint32_t SortedStateChanges = 0;
+            // 排序提交时不透明pass和半透明pass的矩形数
+            uint32_t OpaqueQuads = 0;
+            uint32_t TranslucentQuads = 0;
+            uint32_t ThreadQuads = 0; // 从工作线程上下文合并进来的矩形
+            // 常驻缓冲绘制的矩形数和本帧上传的字节数
+            uint32_t RetainedQuads = 0;
+            uint32_t RetainedUploadBytes = 0;
+            uint32_t GPUCulledQuads = 0; // 常驻缓冲在GPU上剔除掉的矩形
+            // 瓦片地图绘制的块数和本帧上传的字节数
+            uint32_t TilemapChunks = 0;
+            uint32_t TilemapUploadBytes = 0;
+            // 半透明矩形按深度排序时可能比提交顺序切换得更多，这时记为0
+            uint32_t GetSavedStateChanges() const {
+                return UnsortedStateChanges > SortedStateChanges ? UnsortedStateChanges - SortedStateChanges : 0;
+            }
             uint32_t GetTotalVertexCount() const { return QuadCount * 4; }
             uint32_t GetTotalIndexCount() const { return QuadCount * 6; }
         };
@@ -18,6 +18,13 @@ namespace Hazel {
         virtual void SetClearColor(const glm::vec4& color) = 0;
         virtual void Clear() = 0;
         virtual void DrawIndexed(const std::shared_ptr<VertexArray>& vertexArray, uint32_t indexCount = 0) = 0;
+        virtual void DrawIndexedInstanced(const std::shared_ptr<VertexArray>& vertexArray, uint32_t indexCount, uint32_t instanceCount) = 0;
+        // 索引加上baseVertex再取顶点，用于从流式缓冲的某个区域开始绘制
+        virtual void DrawIndexedBaseVertex(const std::shared_ptr<VertexArray>& vertexArray, uint32_t indexCount, uint32_t baseVertex) = 0;
+        // 不用索引缓冲，按顺序绘制vertexCount个顶点，顶点数据由shader根据gl_VertexID自己读取
+        virtual void DrawArrays(const std::shared_ptr<VertexArray>& vertexArray, uint32_t vertexCount) = 0;
+        // 是否写入深度缓冲，深度测试不受影响；半透明的物体关闭写入，后面画的物体仍然能透过它显示
+        virtual void SetDepthWrite(bool enabled) = 0;
         inline static API GetAPI() {return s_API;}
 
     private:
@@ -19,6 +19,17 @@ Ref<Shader> Shader::Create(const std::string& filePath) {
     HZ_CORE_ASSERT(false, "Unknown RendererAPI!");
 }
 
+Ref<Shader> Shader::Create(const std::string& filePath, const std::vector<std::string>& defines) {
+    switch (Renderer::GetAPI()) {
+        case RendererAPI::API::None:
+            HZ_CORE_ASSERT(false, "RendererAPI::None is currently not supported!");
+            return nullptr;
+        case RendererAPI::API::OpenGL:
+            return std::make_shared<OpenGLShader>(filePath, defines);
+    }
+    HZ_CORE_ASSERT(false, "Unknown RendererAPI!");
+}
+
 Ref<Shader> Shader::Create(const std::string& name, const std::string &vertexSrc, const std::string &fragmentSrc) {
     switch (Renderer::GetAPI()) {
         case RendererAPI::API::None:
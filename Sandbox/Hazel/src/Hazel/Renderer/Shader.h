@@ -2,6 +2,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <glm/glm.hpp>
 
@@ -25,6 +26,8 @@ public:
   virtual void SetFloat(const std::string &name, const float value) = 0;
 
   static Ref<Shader> Create(const std::string& filepath);
+  // 同一份源码的变体，每个define插入到各阶段的#version之后，比如"HZ_INSTANCED"
+  static Ref<Shader> Create(const std::string& filepath, const std::vector<std::string>& defines);
   static Ref<Shader> Create(const std::string& name, const std::string& vertexSrc, const std::string& fragmentSrc);
 };
 
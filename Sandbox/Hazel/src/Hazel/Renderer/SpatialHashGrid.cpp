@@ -0,0 +1,174 @@
+#include "SpatialHashGrid.h"
+
+#include <cmath>
+
+#include "Base.h"
+#include "Debugger/Instrumentor.h"
+
+namespace Hazel {
+
+    SpatialHashGrid::SpatialHashGrid(float cellSize) : m_CellSize(cellSize), m_InverseCellSize(1.0f / cellSize) {
+        HZ_CORE_ASSERT(cellSize > 0.0f, "Cell size must be positive!");
+    }
+
+    int32_t SpatialHashGrid::ToCell(float coordinate) const {
+        return (int32_t)std::floor(coordinate * m_InverseCellSize);
+    }
+
+    uint64_t SpatialHashGrid::GetCellKey(const glm::vec2 &position) const {
+        return ((uint64_t)(uint32_t)ToCell(position.x) << 32) | (uint32_t)ToCell(position.y);
+    }
+
+    void SpatialHashGrid::AddToCell(Handle handle) {
+        Item& item = m_Items[handle];
+        item.Cell = GetCellKey(item.Center);
+        auto& cell = m_Cells[item.Cell];
+        item.Slot = (uint32_t)cell.size();
+        cell.push_back(handle);
+    }
+
+    void SpatialHashGrid::RemoveFromCell(Handle handle) {
+        Item& item = m_Items[handle];
+        auto it = m_Cells.find(item.Cell);
+        auto& cell = it->second;
+        Handle last = cell.back();
+        cell[item.Slot] = last;
+        m_Items[last].Slot = item.Slot;
+        cell.pop_back();
+        // 空格子不保留，格子表只包含有物体的格子
+        if (cell.empty()) {
+            m_Cells.erase(it);
+        }
+    }
+
+    SpatialHashGrid::Handle SpatialHashGrid::Insert(const glm::vec2 &center, const glm::vec2 &halfExtent, uint32_t userData) {
+        Handle handle;
+        if (!m_FreeList.empty()) {
+            handle = m_FreeList.back();
+            m_FreeList.pop_back();
+        } else {
+            handle = (Handle)m_Items.size();
+            m_Items.emplace_back();
+        }
+
+        Item& item = m_Items[handle];
+        item.Center = center;
+        item.HalfExtent = glm::abs(halfExtent);
+        item.UserData = userData;
+        item.Alive = true;
+        m_MaxHalfExtent = glm::max(m_MaxHalfExtent, item.HalfExtent);
+        AddToCell(handle);
+
+        m_Count++;
+        return handle;
+    }
+
+    void SpatialHashGrid::Remove(Handle handle) {
+        HZ_CORE_ASSERT(handle < m_Items.size() && m_Items[handle].Alive, "Invalid spatial grid handle!");
+
+        RemoveFromCell(handle);
+        m_Items[handle].Alive = false;
+        m_FreeList.push_back(handle);
+        m_Count--;
+    }
+
+    void SpatialHashGrid::Move(Handle handle, const glm::vec2 &center, const glm::vec2 &halfExtent) {
+        HZ_CORE_ASSERT(handle < m_Items.size() && m_Items[handle].Alive, "Invalid spatial grid handle!");
+
+        Item& item = m_Items[handle];
+        item.HalfExtent = glm::abs(halfExtent);
+        m_MaxHalfExtent = glm::max(m_MaxHalfExtent, item.HalfExtent);
+
+        // 还在同一个格子里时只更新位置
+        if (GetCellKey(center) == item.Cell) {
+            item.Center = center;
+            return;
+        }
+        RemoveFromCell(handle);
+        item.Center = center;
+        AddToCell(handle);
+    }
+
+    void SpatialHashGrid::Build(const glm::vec2 *centers, const glm::vec2 *halfExtents, uint32_t count) {
+        HZ_PROFILE_FUNCTION();
+
+        Clear();
+        m_Items.resize(count);
+
+        // 先统计每个格子的物体数，一次分配好格子列表，避免边插入边扩容
+        std::unordered_map<uint64_t, uint32_t> cellSizes;
+        for (uint32_t i = 0; i < count; i++) {
+            Item& item = m_Items[i];
+            item.Center = centers[i];
+            item.HalfExtent = glm::abs(halfExtents[i]);
+            item.UserData = i;
+            item.Cell = GetCellKey(item.Center);
+            item.Alive = true;
+            m_MaxHalfExtent = glm::max(m_MaxHalfExtent, item.HalfExtent);
+            cellSizes[item.Cell]++;
+        }
+
+        m_Cells.reserve(cellSizes.size());
+        for (auto& [key, size] : cellSizes) {
+            m_Cells[key].reserve(size);
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            auto& cell = m_Cells[m_Items[i].Cell];
+            m_Items[i].Slot = (uint32_t)cell.size();
+            cell.push_back(i);
+        }
+        m_Count = count;
+    }
+
+    void SpatialHashGrid::Clear() {
+        m_Items.clear();
+        m_FreeList.clear();
+        m_Cells.clear();
+        m_MaxHalfExtent = glm::vec2(0.0f);
+        m_Count = 0;
+    }
+
+    void SpatialHashGrid::QueryCell(const std::vector<Handle> &cell, const glm::vec2 &min, const glm::vec2 &max, std::vector<uint32_t> &result) const {
+        for (Handle handle : cell) {
+            const Item& item = m_Items[handle];
+            if (item.Center.x + item.HalfExtent.x >= min.x && item.Center.x - item.HalfExtent.x <= max.x &&
+                item.Center.y + item.HalfExtent.y >= min.y && item.Center.y - item.HalfExtent.y <= max.y) {
+                result.push_back(item.UserData);
+            }
+        }
+    }
+
+    void SpatialHashGrid::Query(const glm::vec2 &min, const glm::vec2 &max, std::vector<uint32_t> &result) const {
+        HZ_PROFILE_FUNCTION();
+
+        if (m_Count == 0) {
+            return;
+        }
+
+        // 物体只按中心点存放，中心点可能在范围外最大半尺寸的地方
+        const glm::vec2 looseMin = min - m_MaxHalfExtent;
+        const glm::vec2 looseMax = max + m_MaxHalfExtent;
+        const int64_t x0 = ToCell(looseMin.x), x1 = ToCell(looseMax.x);
+        const int64_t y0 = ToCell(looseMin.y), y1 = ToCell(looseMax.y);
+
+        // 范围内的格子比已占用的格子还多时（缩得很远），直接遍历已占用的格子更快
+        if ((x1 - x0 + 1) * (y1 - y0 + 1) > (int64_t)m_Cells.size()) {
+            for (auto& [key, cell] : m_Cells) {
+                const int32_t x = (int32_t)(key >> 32), y = (int32_t)(uint32_t)key;
+                if (x >= x0 && x <= x1 && y >= y0 && y <= y1) {
+                    QueryCell(cell, min, max, result);
+                }
+            }
+            return;
+        }
+
+        for (int64_t y = y0; y <= y1; y++) {
+            for (int64_t x = x0; x <= x1; x++) {
+                auto it = m_Cells.find(((uint64_t)(uint32_t)x << 32) | (uint32_t)y);
+                if (it != m_Cells.end()) {
+                    QueryCell(it->second, min, max, result);
+                }
+            }
+        }
+    }
+}
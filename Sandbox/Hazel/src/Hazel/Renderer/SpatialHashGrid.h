@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace Hazel {
+
+    // 静态精灵的哈希均匀网格：每个物体按中心点放进唯一的格子（松散网格），只有被占用的格子才会分配
+    // 查询时把范围向外扩展所有物体里最大的半尺寸，再逐个检查包围盒，代价和查询范围内的物体数成正比，和世界大小无关
+    // 物体尺寸差别很大时最大半尺寸会让查询范围变大，格子大小取常见物体的几倍比较合适
+    class SpatialHashGrid {
+    public:
+        using Handle = uint32_t;
+        static const Handle InvalidHandle = 0xffffffff;
+
+        explicit SpatialHashGrid(float cellSize = 4.0f);
+
+        // userData原样出现在查询结果里，一般是精灵在使用者自己数组里的下标
+        Handle Insert(const glm::vec2& center, const glm::vec2& halfExtent, uint32_t userData);
+        void Remove(Handle handle);
+        void Move(Handle handle, const glm::vec2& center, const glm::vec2& halfExtent);
+        // 清空后一次放入count个物体，第i个物体的handle和userData都是i
+        void Build(const glm::vec2* centers, const glm::vec2* halfExtents, uint32_t count);
+        void Clear();
+
+        // 把包围盒和[min, max]相交的物体的userData追加到result
+        void Query(const glm::vec2& min, const glm::vec2& max, std::vector<uint32_t>& result) const;
+
+        uint32_t GetCount() const { return m_Count; }
+        uint32_t GetCellCount() const { return (uint32_t)m_Cells.size(); }
+        float GetCellSize() const { return m_CellSize; }
+
+    private:
+        struct Item
+        {
+            glm::vec2 Center;
+            glm::vec2 HalfExtent;
+            uint32_t UserData;
+            uint64_t Cell;
+            uint32_t Slot; // 在格子列表里的位置，删除时和最后一个交换
+            bool Alive;
+        };
+
+        int32_t ToCell(float coordinate) const;
+        uint64_t GetCellKey(const glm::vec2& position) const;
+        void AddToCell(Handle handle);
+        void RemoveFromCell(Handle handle);
+        void QueryCell(const std::vector<Handle>& cell, const glm::vec2& min, const glm::vec2& max, std::vector<uint32_t>& result) const;
+
+    private:
+        float m_CellSize;
+        float m_InverseCellSize;
+        glm::vec2 m_MaxHalfExtent = glm::vec2(0.0f); // 只增不减，Build/Clear时重新计算
+        std::vector<Item> m_Items;
+        std::vector<Handle> m_FreeList;
+        std::unordered_map<uint64_t, std::vector<Handle>> m_Cells;
+        uint32_t m_Count = 0;
+    };
+}
@@ -0,0 +1,18 @@
+#include "SpriteCuller.h"
+
+#include "Renderer/Renderer.h"
+#include "Renderer/RendererAPI.h"
+#include "Platform/OpenGL/OpenGLSpriteCuller.h"
+
+namespace Hazel {
+
+    Ref<SpriteCuller> SpriteCuller::Create() {
+        switch (Renderer::GetAPI()) {
+            case RendererAPI::API::None: HZ_CORE_ASSERT(false, "RendererAPI::None is currently not supported!"); return nullptr;
+            case RendererAPI::API::OpenGL: return CreateRef<OpenGLSpriteCuller>();
+        }
+
+        HZ_CORE_ASSERT(false, "Unknow RendererAPI!");
+        return nullptr;
+    }
+}
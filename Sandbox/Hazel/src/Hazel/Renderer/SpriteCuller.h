@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "Core.h"
+#include "Buffer.h"
+#include "VertexArray.h"
+
+namespace Hazel {
+
+    // GPU上的精灵剔除：每条实例记录（和Renderer2D实例化模式的QuadInstance布局一致，64字节）作为一个点，
+    // 包围盒和可见区域相交的记录保持原来的顺序，紧凑地写进输出缓冲，之后直接按实例绘制输出缓冲
+    // OpenGL下用geometry shader加transform feedback实现，只需要GL 3.2
+    // 留下的记录数要从查询对象读回，结果可用之前读取会让CPU等GPU执行完查询之前提交的所有命令（不只是剔除pass），
+    // 所以每个输出缓冲（target）有自己的查询，调用方轮流使用两个target，只读取已经完成的结果
+    class SpriteCuller {
+    public:
+        static const uint32_t TargetCount = 2;
+
+        virtual ~SpriteCuller(){}
+
+        // 发起一次剔除，不等待结果：source的顶点属性按顶点（divisor为0）读取前count条记录，output至少要能放下count条记录
+        virtual void Cull(uint32_t target, const Ref<VertexArray>& source, uint32_t count, const Ref<VertexBuffer>& output,
+                          const glm::vec2& viewMin, const glm::vec2& viewMax) = 0;
+        // target最近一次剔除的结果已经可以读取时，把写进output的记录数写进count并返回true，不阻塞
+        virtual bool PollResult(uint32_t target, uint32_t& count) = 0;
+        // 阻塞到target的结果可以读取为止，和GPU完全同步，只在还没有任何可用结果时使用
+        virtual uint32_t WaitResult(uint32_t target) = 0;
+
+        // 每个GPU剔除的SpriteBuffer一个，剔除用的shader在所有实例之间共享
+        static Ref<SpriteCuller> Create();
+    };
+}
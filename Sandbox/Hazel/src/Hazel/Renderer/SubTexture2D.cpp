@@ -0,0 +1,21 @@
+#include "SubTexture2D.h"
+
+#include "Base.h"
+
+namespace Hazel {
+
+    SubTexture2D::SubTexture2D(const Ref<Texture2D> &texture, const glm::vec2 &uvMin, const glm::vec2 &uvMax)
+        : m_Texture(texture), m_UVMin(uvMin), m_UVMax(uvMax) {
+    }
+
+    Ref<SubTexture2D> SubTexture2D::CreateFromCoords(const Ref<Texture2D> &texture, const glm::vec2 &coords, const glm::vec2 &cellSize,
+                                                     const glm::vec2 &spriteSize) {
+        HZ_CORE_ASSERT(texture, "SubTexture2D needs a texture!");
+
+        const float width = (float)texture->GetWidth();
+        const float height = (float)texture->GetHeight();
+        glm::vec2 uvMin = {coords.x * cellSize.x / width, coords.y * cellSize.y / height};
+        glm::vec2 uvMax = {(coords.x + spriteSize.x) * cellSize.x / width, (coords.y + spriteSize.y) * cellSize.y / height};
+        return CreateRef<SubTexture2D>(texture, uvMin, uvMax);
+    }
+}
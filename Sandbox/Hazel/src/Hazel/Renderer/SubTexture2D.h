@@ -0,0 +1,29 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Core.h"
+#include "Texture.h"
+
+namespace Hazel {
+
+    // 精灵表中的一块区域：引用整张纹理加一个UV矩形，同一张表上的所有区域绘制时共用一个纹理槽
+    class SubTexture2D {
+    public:
+        SubTexture2D(const Ref<Texture2D>& texture, const glm::vec2& uvMin, const glm::vec2& uvMax);
+
+        const Ref<Texture2D>& GetTexture() const { return m_Texture; }
+        const glm::vec2& GetUVMin() const { return m_UVMin; }
+        const glm::vec2& GetUVMax() const { return m_UVMax; }
+
+        // 按网格切分的精灵表：coords为格子坐标（左下角为(0, 0)），cellSize为一个格子的像素大小，
+        // spriteSize为区域占用的格子数，用于跨多个格子的大精灵
+        static Ref<SubTexture2D> CreateFromCoords(const Ref<Texture2D>& texture, const glm::vec2& coords, const glm::vec2& cellSize,
+                                                  const glm::vec2& spriteSize = glm::vec2(1.0f));
+
+    private:
+        Ref<Texture2D> m_Texture;
+        glm::vec2 m_UVMin;
+        glm::vec2 m_UVMax;
+    };
+}
@@ -25,4 +25,24 @@ namespace Hazel {
         HZ_CORE_ASSERT(false, "Unknow RendererAPI!");
         return nullptr;
     }
+
+    Ref<Texture2D> Texture2D::Create(uint32_t width, uint32_t height, TextureFormat format) {
+        switch (Renderer::GetAPI()) {
+            case RendererAPI::API::None: HZ_CORE_ASSERT(false, "RendererAPI::None is currently not supported!"); return nullptr;
+            case RendererAPI::API::OpenGL: return CreateRef<OpenGLTexture2D>(width, height, format);
+        }
+
+        HZ_CORE_ASSERT(false, "Unknow RendererAPI!");
+        return nullptr;
+    }
+
+    Ref<Texture2DArray> Texture2DArray::Create(uint32_t width, uint32_t height, uint32_t layers) {
+        switch (Renderer::GetAPI()) {
+            case RendererAPI::API::None: HZ_CORE_ASSERT(false, "RendererAPI::None is currently not supported!"); return nullptr;
+            case RendererAPI::API::OpenGL: return CreateRef<OpenGLTexture2DArray>(width, height, layers);
+        }
+
+        HZ_CORE_ASSERT(false, "Unknow RendererAPI!");
+        return nullptr;
+    }
 }
\ No newline at end of file
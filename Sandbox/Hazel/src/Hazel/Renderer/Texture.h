@@ -6,6 +6,13 @@
 #include "Core.h"
 
 namespace Hazel {
+    // RGBA8为普通颜色纹理；R16UI为16位无符号整数纹理，只能用texelFetch按下标读取，比如瓦片地图的瓦片编号
+    // R8为单通道8位遮罩，采样结果是(1, 1, 1, r)，线性过滤、边缘截断，比如距离场字体的图集
+    enum class TextureFormat
+    {
+        RGBA8 = 0, R16UI = 1, R8 = 2
+    };
+
     class Texture {
     public:
         virtual ~Texture() = default;
@@ -15,14 +22,32 @@ namespace Hazel {
 
         virtual void SetData(void* data, uint32_t size) = 0;
         virtual void Bind(uint32_t slot = 0) const = 0;
+        // 后端对象的唯一标识，Renderer2D用它做纹理槽查找
+        virtual uint32_t GetRendererID() const = 0;
+        // 纹理带alpha通道，排序提交时按半透明处理
+        virtual bool HasAlpha() const = 0;
 
         virtual bool operator==(const Texture& othre) const = 0;
     };
 
     class Texture2D : public Texture {
     public:
+        // 只更新(x, y)开始的width*height区域，data按纹理格式紧密排列
+        virtual void SetSubData(const void* data, uint32_t x, uint32_t y, uint32_t width, uint32_t height) = 0;
+
         static Ref<Texture2D> Create(const std::string & path);
         static Ref<Texture2D> Create(uint32_t width, uint32_t height);
+        static Ref<Texture2D> Create(uint32_t width, uint32_t height, TextureFormat format);
+    };
+
+    // 尺寸相同的一组RGBA8纹理，shader里用一个sampler2DArray加层号采样
+    class Texture2DArray : public Texture {
+    public:
+        virtual uint32_t GetLayerCount() const = 0;
+        // 更新一层，size必须是一整层的大小；SetData则一次更新所有层
+        virtual void SetLayerData(uint32_t layer, const void* data, uint32_t size) = 0;
+
+        static Ref<Texture2DArray> Create(uint32_t width, uint32_t height, uint32_t layers);
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "TextureArrayPool.h"
+
+#include "stb_image.h"
+
+#include "Base.h"
+#include "Log.h"
+#include "Debugger/Instrumentor.h"
+
+namespace Hazel {
+
+    // GL 3.3保证GL_MAX_ARRAY_TEXTURE_LAYERS至少为256
+    TextureArrayPool::TextureArrayPool() : m_LayersPerArray(256) {
+    }
+
+    TextureArrayPool::TextureArrayPool(uint32_t layersPerArray) : m_LayersPerArray(layersPerArray) {
+        HZ_CORE_ASSERT(layersPerArray > 0, "Texture array needs at least one layer");
+    }
+
+    TextureLayer TextureArrayPool::Allocate(uint32_t width, uint32_t height) {
+        HZ_PROFILE_FUNCTION();
+
+        auto& entries = m_Pools[GetKey(width, height)];
+        for (auto& entry : entries) {
+            if (!entry.FreeLayers.empty()) {
+                uint32_t layer = entry.FreeLayers.back();
+                entry.FreeLayers.pop_back();
+                return {entry.Array, layer};
+            }
+        }
+
+        // 现有数组都满了，新建一个
+        ArrayEntry entry;
+        entry.Array = Texture2DArray::Create(width, height, m_LayersPerArray);
+        entry.FreeLayers.reserve(m_LayersPerArray);
+        for (uint32_t i = m_LayersPerArray; i > 1; i--) {
+            entry.FreeLayers.push_back(i - 1);
+        }
+        entries.push_back(entry);
+        return {entries.back().Array, 0};
+    }
+
+    TextureLayer TextureArrayPool::Add(const void *data, uint32_t width, uint32_t height) {
+        TextureLayer layer = Allocate(width, height);
+        layer.Array->SetLayerData(layer.Layer, data, width * height * 4);
+        return layer;
+    }
+
+    TextureLayer TextureArrayPool::Add(const std::string &path) {
+        HZ_PROFILE_FUNCTION();
+
+        // 和Texture2D一样上下翻转，保证uv方向一致
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load(1);
+        stbi_uc* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        if (!data) {
+            HZ_CORE_ERROR("Failed to load image {0}", path);
+            return {};
+        }
+
+        TextureLayer layer = Add(data, width, height);
+        stbi_image_free(data);
+        return layer;
+    }
+
+    void TextureArrayPool::Free(const TextureLayer &layer) {
+        if (!layer) {
+            return;
+        }
+
+        auto it = m_Pools.find(GetKey(layer.Array->GetWidth(), layer.Array->GetHeight()));
+        if (it == m_Pools.end()) {
+            return;
+        }
+        for (auto& entry : it->second) {
+            if (entry.Array == layer.Array) {
+                entry.FreeLayers.push_back(layer.Layer);
+                return;
+            }
+        }
+    }
+
+    uint32_t TextureArrayPool::GetArrayCount() const {
+        uint32_t count = 0;
+        for (auto& [key, entries] : m_Pools) {
+            count += (uint32_t)entries.size();
+        }
+        return count;
+    }
+
+    uint32_t TextureArrayPool::GetAllocatedLayerCount() const {
+        uint32_t count = 0;
+        for (auto& [key, entries] : m_Pools) {
+            for (auto& entry : entries) {
+                count += m_LayersPerArray - (uint32_t)entry.FreeLayers.size();
+            }
+        }
+        return count;
+    }
+}
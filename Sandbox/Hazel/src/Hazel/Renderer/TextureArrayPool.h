@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Core.h"
+#include "Texture.h"
+
+namespace Hazel {
+
+    // 纹理数组中的一层
+    struct TextureLayer
+    {
+        Ref<Texture2DArray> Array;
+        uint32_t Layer = 0;
+
+        explicit operator bool() const { return Array != nullptr; }
+    };
+
+    // 按尺寸把纹理分组放进Texture2DArray，Renderer2D绘制同一数组里的纹理时不占用纹理槽，也不会因为槽用完而断批
+    // 每个尺寸可以有多个数组，数组里的层用空闲列表分配；图片统一转换成RGBA8
+    class TextureArrayPool {
+    public:
+        TextureArrayPool();
+        explicit TextureArrayPool(uint32_t layersPerArray);
+
+        // 分配一个空的层，之后用Array->SetLayerData写入
+        TextureLayer Allocate(uint32_t width, uint32_t height);
+        // 分配一层并写入紧密排列的RGBA8数据
+        TextureLayer Add(const void* data, uint32_t width, uint32_t height);
+        TextureLayer Add(const std::string& path);
+        void Free(const TextureLayer& layer);
+
+        uint32_t GetArrayCount() const;
+        uint32_t GetAllocatedLayerCount() const;
+
+    private:
+        struct ArrayEntry
+        {
+            Ref<Texture2DArray> Array;
+            std::vector<uint32_t> FreeLayers;
+        };
+
+        static uint64_t GetKey(uint32_t width, uint32_t height) { return ((uint64_t)width << 32) | height; }
+
+    private:
+        uint32_t m_LayersPerArray;
+        std::unordered_map<uint64_t, std::vector<ArrayEntry>> m_Pools;
+    };
+}
@@ -0,0 +1,292 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "stb_image.h"
+
+#include "Base.h"
+#include "Log.h"
+#include "Debugger/Instrumentor.h"
+
+namespace Hazel {
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SkylinePacker ////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    void SkylinePacker::Reset(uint32_t width, uint32_t height) {
+        m_Width = width;
+        m_Height = height;
+        m_UsedArea = 0;
+        m_Nodes.clear();
+        m_Nodes.push_back({0, 0, width});
+    }
+
+    // 从第index段开始放宽width的矩形，y为覆盖到的各段里最高的上边缘
+    bool SkylinePacker::Fit(size_t index, uint32_t width, uint32_t height, uint32_t &y) const {
+        if (m_Nodes[index].X + width > m_Width) {
+            return false;
+        }
+
+        y = m_Nodes[index].Y;
+        uint32_t widthLeft = width;
+        for (size_t i = index; widthLeft > 0; i++) {
+            y = std::max(y, m_Nodes[i].Y);
+            if (y + height > m_Height) {
+                return false;
+            }
+            if (m_Nodes[i].Width >= widthLeft) {
+                break;
+            }
+            widthLeft -= m_Nodes[i].Width;
+        }
+        return true;
+    }
+
+    bool SkylinePacker::Insert(uint32_t width, uint32_t height, uint32_t &x, uint32_t &y) {
+        size_t bestIndex = m_Nodes.size();
+        uint32_t bestTop = UINT32_MAX;
+        uint32_t bestWidth = UINT32_MAX;
+
+        // bottom-left：上边缘最低的位置优先，相同时选更窄的段，减少浪费
+        for (size_t i = 0; i < m_Nodes.size(); i++) {
+            uint32_t top;
+            if (!Fit(i, width, height, top)) {
+                continue;
+            }
+            if (top + height < bestTop || (top + height == bestTop && m_Nodes[i].Width < bestWidth)) {
+                bestIndex = i;
+                bestTop = top + height;
+                bestWidth = m_Nodes[i].Width;
+                y = top;
+            }
+        }
+        if (bestIndex == m_Nodes.size()) {
+            return false;
+        }
+
+        x = m_Nodes[bestIndex].X;
+        m_Nodes.insert(m_Nodes.begin() + bestIndex, {x, y + height, width});
+
+        // 新段右侧被覆盖的部分裁掉
+        for (size_t i = bestIndex + 1; i < m_Nodes.size();) {
+            const Node& prev = m_Nodes[i - 1];
+            Node& node = m_Nodes[i];
+            uint32_t prevRight = prev.X + prev.Width;
+            if (node.X >= prevRight) {
+                break;
+            }
+            uint32_t shrink = prevRight - node.X;
+            if (node.Width <= shrink) {
+                m_Nodes.erase(m_Nodes.begin() + i);
+                continue;
+            }
+            node.X += shrink;
+            node.Width -= shrink;
+            break;
+        }
+
+        // 合并高度相同的相邻段
+        for (size_t i = 0; i + 1 < m_Nodes.size();) {
+            if (m_Nodes[i].Y == m_Nodes[i + 1].Y) {
+                m_Nodes[i].Width += m_Nodes[i + 1].Width;
+                m_Nodes.erase(m_Nodes.begin() + i + 1);
+            } else {
+                i++;
+            }
+        }
+
+        m_UsedArea += width * height;
+        return true;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // TextureAtlas /////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////////////
+
+    TextureAtlas::TextureAtlas() {
+    }
+
+    TextureAtlas::TextureAtlas(const Specification &spec) : m_Specification(spec) {
+    }
+
+    TextureAtlas::Handle TextureAtlas::Add(const void *data, uint32_t width, uint32_t height) {
+        HZ_PROFILE_FUNCTION();
+
+        const uint32_t padding = m_Specification.Padding;
+        if (width + padding > m_Specification.PageSize || height + padding > m_Specification.PageSize) {
+            HZ_CORE_ERROR("Image {0}x{1} does not fit into a {2} atlas page", width, height, m_Specification.PageSize);
+            return InvalidHandle;
+        }
+
+        Handle handle = m_NextHandle++;
+        Image& image = m_Images[handle];
+        image.Pixels.resize((size_t)width * height * 4);
+        memcpy(image.Pixels.data(), data, image.Pixels.size());
+        image.Width = width;
+        image.Height = height;
+        image.LastUsedFrame = m_FrameIndex;
+
+        // 空闲空间不够时整体重新打包，新图片是最近使用的，优先保留
+        if (!Place(image)) {
+            Repack();
+            if (!image.Resident) {
+                HZ_CORE_WARN("Texture atlas is over its memory budget, image {0} is not resident", handle);
+            }
+        }
+        return handle;
+    }
+
+    TextureAtlas::Handle TextureAtlas::Add(const std::string &path) {
+        HZ_PROFILE_FUNCTION();
+
+        // 和Texture2D一样上下翻转，保证uv方向一致
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load(1);
+        stbi_uc* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        if (!data) {
+            HZ_CORE_ERROR("Failed to load image {0}", path);
+            return InvalidHandle;
+        }
+
+        Handle handle = Add(data, width, height);
+        stbi_image_free(data);
+        return handle;
+    }
+
+    void TextureAtlas::Remove(Handle handle) {
+        // 页面上的空间等下一次重新打包时回收
+        m_Images.erase(handle);
+    }
+
+    const TextureAtlas::Region* TextureAtlas::Get(Handle handle) {
+        auto it = m_Images.find(handle);
+        if (it == m_Images.end()) {
+            return nullptr;
+        }
+
+        Image& image = it->second;
+        image.LastUsedFrame = m_FrameIndex;
+        if (!image.Resident && !Place(image)) {
+            m_RepackRequested = true;
+            return nullptr;
+        }
+        return &image.Location;
+    }
+
+    void TextureAtlas::Update() {
+        m_FrameIndex++;
+        if (m_RepackRequested || m_Pages.size() > GetMaxPages()) {
+            Repack();
+        }
+    }
+
+    void TextureAtlas::Repack() {
+        HZ_PROFILE_FUNCTION();
+
+        m_RepackCount++;
+        m_RepackRequested = false;
+
+        if (m_Pages.size() > GetMaxPages()) {
+            m_Pages.resize(GetMaxPages());
+        }
+        for (auto& page : m_Pages) {
+            ClearPage(page);
+        }
+
+        // 最近使用的先放，放不下的就是被驱逐的；同一帧用到的按高度从高到低，天际线更紧凑
+        std::vector<std::pair<Handle, Image*>> order;
+        order.reserve(m_Images.size());
+        for (auto& [handle, image] : m_Images) {
+            order.push_back({handle, &image});
+        }
+        std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+            if (a.second->LastUsedFrame != b.second->LastUsedFrame) {
+                return a.second->LastUsedFrame > b.second->LastUsedFrame;
+            }
+            if (a.second->Height != b.second->Height) {
+                return a.second->Height > b.second->Height;
+            }
+            return a.first < b.first;
+        });
+
+        for (auto& [handle, image] : order) {
+            bool wasResident = image->Resident;
+            image->Resident = false;
+            image->Location = Region();
+            if (!Place(*image) && wasResident) {
+                m_EvictionCount++;
+            }
+        }
+    }
+
+    void TextureAtlas::SetMemoryBudget(uint64_t bytes) {
+        m_Specification.MemoryBudget = bytes;
+        if (m_Pages.size() > GetMaxPages()) {
+            m_RepackRequested = true;
+        }
+    }
+
+    uint64_t TextureAtlas::GetMemoryUsage() const {
+        return (uint64_t)m_Pages.size() * m_Specification.PageSize * m_Specification.PageSize * 4;
+    }
+
+    uint32_t TextureAtlas::GetResidentCount() const {
+        uint32_t count = 0;
+        for (auto& [handle, image] : m_Images) {
+            count += image.Resident ? 1 : 0;
+        }
+        return count;
+    }
+
+    uint32_t TextureAtlas::GetMaxPages() const {
+        uint64_t pageBytes = (uint64_t)m_Specification.PageSize * m_Specification.PageSize * 4;
+        return (uint32_t)std::max<uint64_t>(1, m_Specification.MemoryBudget / pageBytes);
+    }
+
+    bool TextureAtlas::Place(Image &image) {
+        const uint32_t padding = m_Specification.Padding;
+        const float pageSize = (float)m_Specification.PageSize;
+
+        for (size_t i = 0; i <= m_Pages.size(); i++) {
+            // 现有页面都放不下时，预算允许就新开一页
+            if (i == m_Pages.size() && !AddPage()) {
+                return false;
+            }
+
+            Page& page = m_Pages[i];
+            uint32_t x, y;
+            if (!page.Packer.Insert(image.Width + padding, image.Height + padding, x, y)) {
+                continue;
+            }
+
+            page.Texture->SetSubData(image.Pixels.data(), x, y, image.Width, image.Height);
+            image.Location.Page = page.Texture;
+            image.Location.UVMin = {x / pageSize, y / pageSize};
+            image.Location.UVMax = {(x + image.Width) / pageSize, (y + image.Height) / pageSize};
+            image.Resident = true;
+            return true;
+        }
+        return false;
+    }
+
+    bool TextureAtlas::AddPage() {
+        if (m_Pages.size() >= GetMaxPages()) {
+            return false;
+        }
+
+        Page page;
+        page.Texture = Texture2D::Create(m_Specification.PageSize, m_Specification.PageSize);
+        ClearPage(page);
+        m_Pages.push_back(page);
+        return true;
+    }
+
+    void TextureAtlas::ClearPage(Page &page) {
+        // 新纹理的内容是未定义的，旧图片也会残留在间隔里，清成透明避免过滤时串色
+        std::vector<uint8_t> zeros((size_t)m_Specification.PageSize * m_Specification.PageSize * 4, 0);
+        page.Texture->SetData(zeros.data(), (uint32_t)zeros.size());
+        page.Packer.Reset(m_Specification.PageSize, m_Specification.PageSize);
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Core.h"
+#include "Texture.h"
+
+namespace Hazel {
+
+    // 天际线装箱：只记录每一段已占用区域的上边缘，新矩形放到能放下的最低位置（bottom-left）
+    // 不支持单独释放，空间只能通过Reset整体回收
+    class SkylinePacker {
+    public:
+        void Reset(uint32_t width, uint32_t height);
+        bool Insert(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y);
+
+        // 已占用的面积，用于估计页面利用率
+        uint32_t GetUsedArea() const { return m_UsedArea; }
+
+    private:
+        bool Fit(size_t index, uint32_t width, uint32_t height, uint32_t& y) const;
+
+    private:
+        struct Node
+        {
+            uint32_t X, Y, Width;
+        };
+        std::vector<Node> m_Nodes;
+        uint32_t m_Width = 0, m_Height = 0;
+        uint32_t m_UsedArea = 0;
+    };
+
+    // 运行时纹理图集：把大量小图打包进几张大纹理（页），同一页上的图片绘制时共用一个纹理槽
+    // 每张图片在CPU上保留一份RGBA数据，页面总大小超过预算时按最近最少使用驱逐，之后用到时再放回去
+    // Add/Update/Repack会移动页面上的图片，必须在BeginScene/EndScene之外调用；Get只会使用空闲空间，可以在绘制时调用
+    class TextureAtlas {
+    public:
+        struct Specification
+        {
+            uint32_t PageSize = 2048;
+            uint64_t MemoryBudget = 64 * 1024 * 1024; // 所有页面的显存上限，至少保留一页
+            uint32_t Padding = 1;                     // 图片之间的间隔，避免线性过滤采到相邻图片
+        };
+
+        // 图片在页面中的位置，重新打包后会变化，不要长期保存
+        struct Region
+        {
+            Ref<Texture2D> Page;
+            glm::vec2 UVMin = glm::vec2(0.0f);
+            glm::vec2 UVMax = glm::vec2(1.0f);
+        };
+
+        using Handle = uint32_t;
+        static const Handle InvalidHandle = 0;
+
+        TextureAtlas();
+        explicit TextureAtlas(const Specification& spec);
+
+        // 添加一张图片，data为紧密排列的RGBA8数据
+        Handle Add(const void* data, uint32_t width, uint32_t height);
+        Handle Add(const std::string& path);
+        void Remove(Handle handle);
+
+        // 取图片所在的区域并标记为本帧使用；已被驱逐且放不进空闲空间时返回nullptr，等下一次Update重新打包
+        const Region* Get(Handle handle);
+
+        // 每帧开始绘制前调用一次：推进帧计数，有图片等待放回页面时重新打包
+        void Update();
+        // 清空所有页面，按最近使用的顺序重新放入图片，放不下的被驱逐
+        void Repack();
+
+        void SetMemoryBudget(uint64_t bytes);
+
+        uint32_t GetPageCount() const { return (uint32_t)m_Pages.size(); }
+        uint64_t GetMemoryUsage() const;
+        uint32_t GetImageCount() const { return (uint32_t)m_Images.size(); }
+        uint32_t GetResidentCount() const;
+        uint32_t GetEvictionCount() const { return m_EvictionCount; }
+        uint32_t GetRepackCount() const { return m_RepackCount; }
+
+    private:
+        struct Image
+        {
+            std::vector<uint8_t> Pixels;
+            uint32_t Width, Height;
+            bool Resident = false;
+            uint64_t LastUsedFrame = 0;
+            Region Location;
+        };
+
+        struct Page
+        {
+            Ref<Texture2D> Texture;
+            SkylinePacker Packer;
+        };
+
+        uint32_t GetMaxPages() const;
+        bool Place(Image& image);
+        bool AddPage();
+        void ClearPage(Page& page);
+
+    private:
+        Specification m_Specification;
+        std::vector<Page> m_Pages;
+        std::unordered_map<Handle, Image> m_Images;
+        Handle m_NextHandle = 1;
+
+        uint64_t m_FrameIndex = 0;
+        bool m_RepackRequested = false;
+        uint32_t m_EvictionCount = 0;
+        uint32_t m_RepackCount = 0;
+    };
+}
@@ -0,0 +1,83 @@
+#include "Tilemap.h"
+
+#include <algorithm>
+
+#include "Base.h"
+#include "Debugger/Instrumentor.h"
+
+namespace Hazel {
+
+    Tilemap::Tilemap(uint32_t width, uint32_t height, const Ref<Texture2D> &tileset, uint32_t tilesetColumns, uint32_t tilesetRows)
+        : m_Width(width), m_Height(height), m_Tileset(tileset), m_TilesetColumns(tilesetColumns), m_TilesetRows(tilesetRows) {
+        HZ_PROFILE_FUNCTION();
+
+        HZ_CORE_ASSERT(tileset && tilesetColumns > 0 && tilesetRows > 0, "Tilemap needs a tileset!");
+
+        m_ChunkColumns = (width + ChunkSize - 1) / ChunkSize;
+        m_ChunkRows = (height + ChunkSize - 1) / ChunkSize;
+        m_Chunks.resize((size_t)m_ChunkColumns * m_ChunkRows);
+        for (auto& chunk : m_Chunks) {
+            chunk.Tiles.assign(ChunkSize * ChunkSize, 0);
+        }
+    }
+
+    void Tilemap::WriteTile(uint32_t x, uint32_t y, uint16_t tile) {
+        Chunk& chunk = GetChunk(x, y);
+        const uint32_t row = y % ChunkSize;
+        uint16_t& slot = chunk.Tiles[row * ChunkSize + x % ChunkSize];
+        if (slot == tile) {
+            return;
+        }
+        chunk.TileCount += (tile != 0) - (slot != 0);
+        slot = tile;
+        // 还没有纹理的块第一次绘制时整块上传，不需要记录脏行
+        if (chunk.Indices) {
+            chunk.DirtyBegin = std::min(chunk.DirtyBegin, row);
+            chunk.DirtyEnd = std::max(chunk.DirtyEnd, row + 1);
+        }
+    }
+
+    void Tilemap::SetTile(uint32_t x, uint32_t y, uint16_t tile) {
+        HZ_CORE_ASSERT(x < m_Width && y < m_Height, "Tile out of tilemap bounds!");
+        WriteTile(x, y, tile);
+    }
+
+    uint16_t Tilemap::GetTile(uint32_t x, uint32_t y) const {
+        HZ_CORE_ASSERT(x < m_Width && y < m_Height, "Tile out of tilemap bounds!");
+        const Chunk& chunk = m_Chunks[(y / ChunkSize) * m_ChunkColumns + x / ChunkSize];
+        return chunk.Tiles[(y % ChunkSize) * ChunkSize + x % ChunkSize];
+    }
+
+    void Tilemap::SetTiles(uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint16_t *tiles) {
+        HZ_PROFILE_FUNCTION();
+
+        HZ_CORE_ASSERT(x + width <= m_Width && y + height <= m_Height, "Region out of tilemap bounds!");
+        for (uint32_t row = 0; row < height; row++) {
+            for (uint32_t column = 0; column < width; column++) {
+                WriteTile(x + column, y + row, tiles[row * width + column]);
+            }
+        }
+    }
+
+    bool Tilemap::PrepareChunk(Chunk &chunk) {
+        if (chunk.TileCount == 0) {
+            return false;
+        }
+
+        if (!chunk.Indices) {
+            chunk.Indices = Texture2D::Create(ChunkSize, ChunkSize, TextureFormat::R16UI);
+            chunk.Indices->SetData(chunk.Tiles.data(), ChunkSize * ChunkSize * sizeof(uint16_t));
+            m_UploadBytes += ChunkSize * ChunkSize * sizeof(uint16_t);
+            chunk.DirtyBegin = ChunkSize;
+            chunk.DirtyEnd = 0;
+        } else if (chunk.DirtyBegin < chunk.DirtyEnd) {
+            // 改动的行在块里是连续的，整行上传
+            const uint32_t rows = chunk.DirtyEnd - chunk.DirtyBegin;
+            chunk.Indices->SetSubData(&chunk.Tiles[chunk.DirtyBegin * ChunkSize], 0, chunk.DirtyBegin, ChunkSize, rows);
+            m_UploadBytes += rows * ChunkSize * sizeof(uint16_t);
+            chunk.DirtyBegin = ChunkSize;
+            chunk.DirtyEnd = 0;
+        }
+        return true;
+    }
+}
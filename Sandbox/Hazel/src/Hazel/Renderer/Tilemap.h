@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Core.h"
+#include "Texture.h"
+
+namespace Hazel {
+
+    // 分块的瓦片地图：瓦片编号按ChunkSize x ChunkSize分块，每块存进一张R16UI整数纹理
+    // 绘制时每个可见的块只画一个矩形，由fragment shader读出瓦片编号再去采样图块集，开销只和屏幕上的块数有关，和瓦片数无关
+    // 编号0为空瓦片，不绘制；编号i对应图块集里从左下角开始、按行排列的第i-1格
+    // 块的纹理在第一次可见时才创建，修改瓦片只上传改动的行；用Renderer2D::DrawTilemap绘制
+    class Tilemap {
+    public:
+        static constexpr uint32_t ChunkSize = 32;
+
+        // tileset按tilesetColumns x tilesetRows等分成格子
+        Tilemap(uint32_t width, uint32_t height, const Ref<Texture2D>& tileset, uint32_t tilesetColumns, uint32_t tilesetRows);
+
+        void SetTile(uint32_t x, uint32_t y, uint16_t tile);
+        uint16_t GetTile(uint32_t x, uint32_t y) const;
+        // 写入从(x, y)开始的width x height区域，tiles按行紧密排列，第一行在最下面
+        void SetTiles(uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint16_t* tiles);
+
+        // 瓦片(0, 0)左下角所在的世界坐标和深度，以及每个瓦片的世界尺寸
+        void SetPosition(const glm::vec3& position) { m_Position = position; }
+        void SetTileSize(float tileSize) { m_TileSize = tileSize; }
+        const glm::vec3& GetPosition() const { return m_Position; }
+        float GetTileSize() const { return m_TileSize; }
+
+        uint32_t GetWidth() const { return m_Width; }
+        uint32_t GetHeight() const { return m_Height; }
+        const Ref<Texture2D>& GetTileset() const { return m_Tileset; }
+        uint32_t GetTilesetColumns() const { return m_TilesetColumns; }
+        uint32_t GetTilesetRows() const { return m_TilesetRows; }
+
+        // 本帧上传到GPU的字节数，DrawTilemap之后读取，下一次绘制时清零
+        uint32_t GetUploadBytes() const { return m_UploadBytes; }
+
+    private:
+        friend class Renderer2D;
+
+        struct Chunk
+        {
+            std::vector<uint16_t> Tiles; // ChunkSize * ChunkSize，按行排列
+            Ref<Texture2D> Indices;      // 第一次可见时创建
+            uint32_t TileCount = 0;      // 非空瓦片数，为0的块不绘制
+            uint32_t DirtyBegin = ChunkSize, DirtyEnd = 0; // 需要上传的行[begin, end)
+        };
+
+        Chunk& GetChunk(uint32_t x, uint32_t y) { return m_Chunks[(y / ChunkSize) * m_ChunkColumns + x / ChunkSize]; }
+        void WriteTile(uint32_t x, uint32_t y, uint16_t tile);
+        // 创建块的纹理或者上传脏的行，返回块是否需要绘制
+        bool PrepareChunk(Chunk& chunk);
+
+    private:
+        uint32_t m_Width, m_Height;
+        uint32_t m_ChunkColumns, m_ChunkRows;
+        std::vector<Chunk> m_Chunks;
+
+        Ref<Texture2D> m_Tileset;
+        uint32_t m_TilesetColumns, m_TilesetRows;
+
+        glm::vec3 m_Position = glm::vec3(0.0f);
+        float m_TileSize = 1.0f;
+        uint32_t m_UploadBytes = 0;
+    };
+}
@@ -0,0 +1,99 @@
+#include "Triangulator.h"
+
+#include "Debugger/Instrumentor.h"
+
+namespace Hazel {
+
+    namespace {
+        // (b - a) x (c - a)，大于0时a、b、c为逆时针
+        float Cross(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c) {
+            return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        }
+
+        // 逆时针三角形abc，边上的点也算在里面
+        bool InTriangle(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b, const glm::vec2& c) {
+            return Cross(a, b, p) >= 0.0f && Cross(b, c, p) >= 0.0f && Cross(c, a, p) >= 0.0f;
+        }
+    }
+
+    bool Triangulator::Triangulate(const glm::vec2 *outline, uint32_t count, std::vector<uint32_t> &indices) {
+        HZ_PROFILE_FUNCTION();
+
+        if (count < 3) {
+            return false;
+        }
+
+        // 有向面积的符号决定遍历方向，顺时针的多边形倒着走，切出来的三角形都是逆时针
+        float area = 0.0f;
+        for (uint32_t i = 0, j = count - 1; i < count; j = i++) {
+            area += outline[j].x * outline[i].y - outline[i].x * outline[j].y;
+        }
+        if (area == 0.0f) {
+            return false;
+        }
+
+        // 剩下的顶点组成双向链表
+        std::vector<uint32_t> prev(count), next(count);
+        for (uint32_t i = 0; i < count; i++) {
+            const uint32_t after = (i + 1) % count;
+            const uint32_t before = (i + count - 1) % count;
+            next[i] = area > 0.0f ? after : before;
+            prev[i] = area > 0.0f ? before : after;
+        }
+
+        auto isEar = [&](uint32_t a, uint32_t b, uint32_t c) {
+            const glm::vec2& pa = outline[a];
+            const glm::vec2& pb = outline[b];
+            const glm::vec2& pc = outline[c];
+            const float cross = Cross(pa, pb, pc);
+            if (cross < 0.0f) {
+                return false; // 凹顶点
+            }
+            if (cross == 0.0f) {
+                // 共线的顶点：沿同一方向继续时切掉它只产生一个退化三角形，折返的尖刺不能切
+                return (pb.x - pa.x) * (pc.x - pb.x) + (pb.y - pa.y) * (pc.y - pb.y) > 0.0f;
+            }
+            // 只有凹顶点可能落在凸顶点的三角形里，这里不单独维护凹顶点表，直接检查剩下的所有顶点
+            for (uint32_t v = next[c]; v != a; v = next[v]) {
+                const glm::vec2& p = outline[v];
+                // 和三角形顶点重合的点（比如相接的两段轮廓）不算
+                if (p == pa || p == pb || p == pc) {
+                    continue;
+                }
+                if (InTriangle(p, pa, pb, pc)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        indices.reserve(indices.size() + (count - 2) * 3);
+        uint32_t remaining = count;
+        uint32_t current = 0;
+        uint32_t misses = 0;
+        while (remaining > 3) {
+            const uint32_t before = prev[current];
+            const uint32_t after = next[current];
+            if (isEar(before, current, after)) {
+                indices.push_back(before);
+                indices.push_back(current);
+                indices.push_back(after);
+                next[before] = after;
+                prev[after] = before;
+                remaining--;
+                misses = 0;
+                current = after;
+            } else {
+                current = after;
+                // 转了一整圈都没有耳朵，多边形自交或者数值上退化了
+                if (++misses > remaining) {
+                    return false;
+                }
+            }
+        }
+        indices.push_back(prev[current]);
+        indices.push_back(current);
+        indices.push_back(next[current]);
+        return true;
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace Hazel {
+    // 简单多边形的三角化，用于Renderer2D::DrawPolygon
+    // 耳切法：每次找一个凸顶点，它和相邻两个顶点组成的三角形里没有其它顶点，就把这个“耳朵”切下来，O(n^2)
+    // 支持凸多边形和凹多边形，顶点顺时针或逆时针排列都可以；不支持自交和带洞的多边形
+    class Triangulator {
+    public:
+        // 三角形的顶点下标追加到indices后面（相对于outline），每3个一个三角形，统一为逆时针
+        // 多边形退化或者自交导致找不到耳朵时，已经切下的三角形保留在indices里，返回false
+        static bool Triangulate(const glm::vec2* outline, uint32_t count, std::vector<uint32_t>& indices);
+    };
+}
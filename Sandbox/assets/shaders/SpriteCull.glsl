@@ -0,0 +1,85 @@
+// Sprite Culling Shader
+// 没有片元阶段，光栅化关闭：每条QuadInstance记录作为一个点输入，geometry shader只把包围盒和可见区域相交的记录
+// 通过transform feedback按原顺序紧凑地写进输出缓冲，输出变量的顺序和QuadInstance的布局一致
+
+#type vertex
+#version 330 core
+
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec2 a_Size;
+layout(location = 2) in float a_Rotation;
+layout(location = 3) in vec4 a_Color;
+layout(location = 4) in vec4 a_TexRect;
+layout(location = 5) in float a_TexIndex;
+layout(location = 6) in float a_TilingFactor;
+
+out vec3 g_Position;
+out vec2 g_Size;
+out float g_Rotation;
+out vec4 g_Color;
+out vec4 g_TexRect;
+out float g_TexIndex;
+out float g_TilingFactor;
+
+void main()
+{
+	  g_Position = a_Position;
+	  g_Size = a_Size;
+	  g_Rotation = a_Rotation;
+	  g_Color = a_Color;
+	  g_TexRect = a_TexRect;
+	  g_TexIndex = a_TexIndex;
+	  g_TilingFactor = a_TilingFactor;
+}
+
+#type geometry
+#version 330 core
+
+layout(points) in;
+layout(points, max_vertices = 1) out;
+
+// 世界空间的可见区域：左下角xy，右上角zw
+uniform vec4 u_ViewBounds;
+
+in vec3 g_Position[];
+in vec2 g_Size[];
+in float g_Rotation[];
+in vec4 g_Color[];
+in vec4 g_TexRect[];
+in float g_TexIndex[];
+in float g_TilingFactor[];
+
+out vec3 o_Position;
+out vec2 o_Size;
+out float o_Rotation;
+out vec4 o_Color;
+out vec4 o_TexRect;
+out float o_TexIndex;
+out float o_TilingFactor;
+
+void main()
+{
+	  // 删除的精灵整条记录为0，直接丢掉
+	  if (g_Size[0] == vec2(0.0)) {
+	      return;
+	  }
+	  // 旋转后矩形的轴对齐包围盒的半边长
+	  float c = abs(cos(g_Rotation[0]));
+	  float s = abs(sin(g_Rotation[0]));
+	  vec2 halfSize = 0.5 * abs(g_Size[0]);
+	  vec2 extent = vec2(halfSize.x * c + halfSize.y * s, halfSize.x * s + halfSize.y * c);
+	  vec2 center = g_Position[0].xy;
+	  if (any(lessThan(center + extent, u_ViewBounds.xy)) || any(greaterThan(center - extent, u_ViewBounds.zw))) {
+	      return;
+	  }
+
+	  o_Position = g_Position[0];
+	  o_Size = g_Size[0];
+	  o_Rotation = g_Rotation[0];
+	  o_Color = g_Color[0];
+	  o_TexRect = g_TexRect[0];
+	  o_TexIndex = g_TexIndex[0];
+	  o_TilingFactor = g_TilingFactor[0];
+	  EmitVertex();
+	  EndPrimitive();
+}
@@ -3,6 +3,27 @@
 #type vertex
 #version 330 core
 
+#ifdef HZ_INSTANCED
+// 实例化模式：每个实例一条记录，四个顶点在vertex shader里展开
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec2 a_Size;
+layout(location = 2) in float a_Rotation;
+layout(location = 3) in vec4 a_Color;
+// 采样的纹理区域：左下角uv, 右上角uv
+layout(location = 4) in vec4 a_TexRect;
+layout(location = 5) in float a_TexIndex;
+layout(location = 6) in float a_TilingFactor;
+#elif defined(HZ_VERTEX_PULLING)
+// 顶点拉取：没有顶点属性，每个矩形的记录是纹理缓冲里连续的4个RGBA32F纹素，布局和实例化模式的属性一致
+// (Position.xyz, Size.x) (Size.y, Rotation, Color.rg) (Color.ba, TexRect.xy) (TexRect.zw, TexIndex, TilingFactor)
+uniform samplerBuffer u_QuadRecords;
+#elif defined(HZ_PACKED_VERTEX)
+// 压缩顶点：a_DepthTexIndex为(z, 纹理索引)，a_TexCoord已经乘过tiling缩放因子，颜色由8位归一化得到
+layout(location = 0) in vec2 a_Position;
+layout(location = 1) in vec2 a_DepthTexIndex;
+layout(location = 2) in vec2 a_TexCoord;
+layout(location = 3) in vec4 a_Color;
+#else
 layout(location = 0) in vec3 a_Position;
 layout(location = 1) in vec4 a_Color;
 layout(location = 2) in vec2 a_TexCoord;
@@ -10,6 +31,7 @@ layout(location = 2) in vec2 a_TexCoord;
 layout(location = 3) in float a_TexIndex;
 // 支持tiling缩放因子
 layout(location = 4) in float a_TilingFactor;
+#endif
 
 uniform mat4 u_ViewProjection;
 
@@ -20,15 +42,102 @@ out float v_TexIndex;
 // 输出tiling缩放因子到片元着色器
 out float v_TilingFactor;
 
+// 形状（圆、线段、圆角矩形）：纹理索引(-2.5, -2]为直角矩形，(-3.5, -3]为圆角矩形，小数部分乘2是描边宽度占最短半边的比例
+// 纹理坐标是以单位长度计量的局部坐标，四个角的绝对值都是半边长，所以在顶点上就能算出来
+flat out int v_Shape; // 0为普通矩形，1为直角矩形，2为圆角矩形（圆角半径为单位长度）
+flat out vec2 v_ShapeExtent;
+flat out float v_ShapeOutline;
+
+#ifdef HZ_LIGHTING
+// 光照变体：片元的世界坐标，和光源的位置比较
+out vec2 v_WorldPosition;
+#endif
+
+void SetShape(float texIndex, vec2 texCoord)
+{
+	  v_Shape = 0;
+	  v_ShapeExtent = vec2(0.0);
+	  v_ShapeOutline = 0.0;
+	  if (texIndex > -1.5) {
+	      return;
+	  }
+	  float code = -texIndex - 2.0;
+	  int shape = int(code + 0.25);
+	  v_Shape = shape + 1;
+	  v_ShapeExtent = abs(texCoord);
+	  v_ShapeOutline = (code - float(shape)) * 2.0 * min(v_ShapeExtent.x, v_ShapeExtent.y);
+}
+
+#if defined(HZ_INSTANCED) || defined(HZ_VERTEX_PULLING)
+// 与Renderer2D的顶点顺序一致：左下、右下、右上、左上，实例化时gl_VertexID取自索引缓冲里的0~3
+const vec2 c_Corners[4] = vec2[4](vec2(-0.5, -0.5), vec2(0.5, -0.5), vec2(0.5, 0.5), vec2(-0.5, 0.5));
+#ifdef HZ_VERTEX_PULLING
+// 每个矩形6个顶点，两个三角形的角和索引缓冲里的顺序一致
+const int c_CornerIndices[6] = int[6](0, 1, 2, 2, 3, 0);
+#endif
+
+void main()
+{
+#ifdef HZ_VERTEX_PULLING
+	  int record = gl_VertexID / 6 * 4;
+	  vec4 r0 = texelFetch(u_QuadRecords, record);
+	  vec4 r1 = texelFetch(u_QuadRecords, record + 1);
+	  vec4 r2 = texelFetch(u_QuadRecords, record + 2);
+	  vec4 r3 = texelFetch(u_QuadRecords, record + 3);
+	  vec3 a_Position = r0.xyz;
+	  vec2 a_Size = vec2(r0.w, r1.x);
+	  float a_Rotation = r1.y;
+	  vec4 a_Color = vec4(r1.zw, r2.xy);
+	  vec4 a_TexRect = vec4(r2.zw, r3.xy);
+	  float a_TexIndex = r3.z;
+	  float a_TilingFactor = r3.w;
+	  vec2 corner = c_Corners[c_CornerIndices[gl_VertexID % 6]];
+#else
+	  vec2 corner = c_Corners[gl_VertexID];
+#endif
+	  vec2 local = corner * a_Size;
+	  float c = cos(a_Rotation);
+	  float s = sin(a_Rotation);
+	  vec2 world = a_Position.xy + vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+
+	  v_Color = a_Color;
+	  v_TexCoord = mix(a_TexRect.xy, a_TexRect.zw, corner + 0.5);
+	  v_TexIndex = a_TexIndex;
+	  v_TilingFactor = a_TilingFactor;
+	  SetShape(a_TexIndex, v_TexCoord);
+#ifdef HZ_LIGHTING
+	  v_WorldPosition = world;
+#endif
+	  gl_Position = u_ViewProjection * vec4(world, a_Position.z, 1.0);
+}
+#elif defined(HZ_PACKED_VERTEX)
+void main()
+{
+	  v_Color = a_Color;
+	  v_TexCoord = a_TexCoord;
+	  v_TexIndex = a_DepthTexIndex.y;
+	  v_TilingFactor = 1.0;
+	  SetShape(a_DepthTexIndex.y, a_TexCoord);
+#ifdef HZ_LIGHTING
+	  v_WorldPosition = a_Position;
+#endif
+	  gl_Position = u_ViewProjection * vec4(a_Position, a_DepthTexIndex.x, 1.0);
+}
+#else
 void main()
 {
    v_Color = a_Color;
 	  v_TexCoord = a_TexCoord;
 	  v_TexIndex = a_TexIndex;
 	  v_TilingFactor = a_TilingFactor;
+	  SetShape(a_TexIndex, a_TexCoord);
+#ifdef HZ_LIGHTING
+	  v_WorldPosition = a_Position.xy;
+#endif
 //	 gl_Position = u_ViewProjection * u_Transform * vec4(a_Position, 1.0);
 	  gl_Position = u_ViewProjection * vec4(a_Position, 1.0);
 }
+#endif
 
 #type fragment
 #version 330 core
@@ -39,12 +148,107 @@ in vec4 v_Color;
 in vec2 v_TexCoord;
 in float v_TexIndex;
 in float v_TilingFactor;
+flat in int v_Shape;
+flat in vec2 v_ShapeExtent;
+flat in float v_ShapeOutline;
 
-// 纹理数组u_Textures只是存储[0~15]的索引
+#ifdef HZ_TEXTURE_ARRAY
+// 纹理数组批次：v_TexIndex是层号，整个批次只有一个采样器
+uniform sampler2DArray u_TextureArray;
+#else
+#ifndef HZ_MAX_TEXTURE_SLOTS
+#define HZ_MAX_TEXTURE_SLOTS 16
+#endif
+// 纹理数组u_Textures只是存储[0~HZ_MAX_TEXTURE_SLOTS-1]的索引，长度由Renderer2D按GPU的纹理单元数注入
 // 实际绑定到哪个纹理上是在外面的程序中实现
-uniform sampler2D u_Textures[16];
+uniform sampler2D u_Textures[HZ_MAX_TEXTURE_SLOTS];
+#endif
+
+#ifdef HZ_LIGHTING
+in vec2 v_WorldPosition;
+// 每个光源2个纹素：(位置xy, 半径, 强度) (颜色rgb, 0)
+uniform samplerBuffer u_Lights;
+// [0, 瓦片数]是每个瓦片的光源下标在本缓冲里的起始位置，第i个瓦片的光源是[start(i), start(i + 1))
+uniform usamplerBuffer u_LightGrid;
+// (瓦片像素大小, 横向瓦片数, 纵向瓦片数, 0)
+uniform vec4 u_LightGridParams;
+uniform vec3 u_AmbientLight;
+
+// 只累加片元所在瓦片里的光源
+vec3 ComputeLighting()
+{
+	 ivec2 tiles = ivec2(u_LightGridParams.yz);
+	 ivec2 tile = min(ivec2(gl_FragCoord.xy) / int(u_LightGridParams.x), tiles - 1);
+	 int index = tile.y * tiles.x + tile.x;
+	 int begin = int(texelFetch(u_LightGrid, index).r);
+	 int end = int(texelFetch(u_LightGrid, index + 1).r);
+	 vec3 light = u_AmbientLight;
+	 for (int i = begin; i < end; i++) {
+	     int record = int(texelFetch(u_LightGrid, i).r) * 2;
+	     vec4 positionRadius = texelFetch(u_Lights, record);
+	     vec3 lightColor = texelFetch(u_Lights, record + 1).rgb;
+	     float d = length(v_WorldPosition - positionRadius.xy) / positionRadius.z;
+	     float falloff = clamp(1.0 - d * d, 0.0, 1.0);
+	     light += lightColor * positionRadius.w * falloff * falloff;
+	 }
+	 return light;
+}
+#endif
+
+// 圆角矩形的有向距离，单位和纹理坐标一致；直角矩形的圆角半径为0，圆是半边长为1的圆角矩形
+float ShapeCoverage()
+{
+	 float radius = v_Shape == 2 ? 1.0 : 0.0;
+	 vec2 q = abs(v_TexCoord) - (v_ShapeExtent - radius);
+	 float distance = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+	 // 描边：只保留边缘向内v_ShapeOutline宽的一圈
+	 if (v_ShapeOutline > 0.0) {
+	     distance = abs(distance + v_ShapeOutline * 0.5) - v_ShapeOutline * 0.5;
+	 }
+	 float width = max(fwidth(distance), 1e-4) * 0.5;
+	 return 1.0 - smoothstep(-width, width, distance);
+}
+
+// 没有光照时的片元颜色
+vec4 SurfaceColor()
+{
+	 if (v_Shape != 0) {
+	     float alpha = ShapeCoverage() * v_Color.a;
+	     // 外接矩形在形状以外的部分不写深度
+	     if (alpha <= 0.0) {
+	         discard;
+	     }
+	     return vec4(v_Color.rgb, alpha);
+	 }
+	 // 纯色矩形的纹理索引为负数，不采样
+	 if (v_TexIndex < 0.0) {
+	     return v_Color;
+	 }
+#ifdef HZ_DISTANCE_FIELD_OFFSET
+	 // 文字字形：索引减去偏移才是纹理槽，纹理里存的是有向距离场，0.5为字形边缘
+	 // fwidth随屏幕上的缩放变化，任何字号下边缘都只过渡大约一个像素
+	 if (v_TexIndex >= HZ_DISTANCE_FIELD_OFFSET) {
+	     float distance = texture(u_Textures[int(v_TexIndex - HZ_DISTANCE_FIELD_OFFSET)], v_TexCoord).a;
+	     float width = max(fwidth(distance), 1e-4);
+	     float alpha = smoothstep(0.5 - width, 0.5 + width, distance) * v_Color.a;
+	     // 字形矩形的空白部分不写深度，不挡住后面画的东西
+	     if (alpha <= 0.0) {
+	         discard;
+	     }
+	     return vec4(v_Color.rgb, alpha);
+	 }
+#endif
+#ifdef HZ_TEXTURE_ARRAY
+	 return texture(u_TextureArray, vec3(v_TexCoord * v_TilingFactor, v_TexIndex)) * v_Color;
+#else
+	 return texture(u_Textures[int(v_TexIndex)], v_TexCoord * v_TilingFactor) * v_Color;
+#endif
+}
 
 void main()
 {
-	 color = texture(u_Textures[int(v_TexIndex)], v_TexCoord * v_TilingFactor) * v_Color;
+	 color = SurfaceColor();
+#ifdef HZ_LIGHTING
+	 color.rgb *= ComputeLighting();
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,56 @@
+// Tilemap Chunk Shader
+
+#type vertex
+#version 330 core
+
+// 单位矩形的顶点，(0, 0)~(1, 1)
+layout(location = 0) in vec2 a_Position;
+
+uniform mat4 u_ViewProjection;
+// 块在世界中的矩形：左下角xy，尺寸zw
+uniform vec4 u_ChunkRect;
+uniform float u_Depth;
+// 一个块的边长（瓦片数）
+uniform float u_ChunkSize;
+
+// 以瓦片为单位的坐标，整数部分是瓦片下标，小数部分是瓦片内的位置
+out vec2 v_TileCoord;
+
+void main()
+{
+	  v_TileCoord = a_Position * u_ChunkSize;
+	  gl_Position = u_ViewProjection * vec4(u_ChunkRect.xy + a_Position * u_ChunkRect.zw, u_Depth, 1.0);
+}
+
+#type fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TileCoord;
+
+uniform usampler2D u_TileIndices;
+uniform sampler2D u_Tileset;
+// 图块集的列数和行数，只用xy
+uniform vec4 u_TilesetGrid;
+
+void main()
+{
+	 ivec2 tile = clamp(ivec2(floor(v_TileCoord)), ivec2(0), textureSize(u_TileIndices, 0) - 1);
+	 uint index = texelFetch(u_TileIndices, tile, 0).r;
+	 // 0为空瓦片
+	 if (index == 0u) {
+	     discard;
+	 }
+
+	 vec2 grid = u_TilesetGrid.xy;
+	 uint columns = uint(grid.x);
+	 vec2 cell = vec2(float((index - 1u) % columns), float((index - 1u) / columns));
+	 // 每个瓦片内部用图块的中间部分采样，避免线性过滤时采到相邻的图块
+	 vec2 texelSize = 1.0 / vec2(textureSize(u_Tileset, 0));
+	 vec2 local = clamp(fract(v_TileCoord), texelSize * grid * 0.5, 1.0 - texelSize * grid * 0.5);
+	 color = texture(u_Tileset, (cell + local) / grid);
+	 if (color.a <= 0.0) {
+	     discard;
+	 }
+}
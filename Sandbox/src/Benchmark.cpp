@@ -0,0 +1,271 @@
+#include "Benchmark.h"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Renderer/QuadKernel.h"
+#include "Renderer/SpatialHashGrid.h"
+#include "Renderer/ParticleSystem.h"
+#include "Renderer/LightGrid.h"
+#include "OrthographicCameraController.h"
+#include "Debugger/Instrumentor.h"
+
+namespace {
+    // 防止编译器把没有使用的计算结果优化掉
+    volatile float s_Sink = 0.0f;
+
+    template<typename Fn>
+    float MeasureMilliseconds(uint32_t iterations, Fn&& func)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            func();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<float, std::milli>(end - start).count();
+    }
+}
+
+std::vector<Benchmark::Result> Benchmark::RunQuadKernel(uint32_t quadCount, uint32_t iterations) {
+    HZ_PROFILE_FUNCTION();
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> posDist(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> sizeDist(0.1f, 2.0f);
+    std::uniform_real_distribution<float> rotDist(0.0f, 360.0f);
+
+    std::vector<glm::vec2> positions(quadCount), sizes(quadCount);
+    std::vector<float> rotations(quadCount);
+    for (uint32_t i = 0; i < quadCount; i++) {
+        positions[i] = {posDist(rng), posDist(rng)};
+        sizes[i] = {sizeDist(rng), sizeDist(rng)};
+        rotations[i] = glm::radians(rotDist(rng));
+    }
+
+    std::vector<float> xs(quadCount * 4), ys(quadCount * 4);
+    std::vector<Result> results;
+    auto addResult = [&](const std::string& name, float ms) {
+        float quadsPerMs = (float)quadCount * (float)iterations / ms;
+        results.push_back({name, quadsPerMs, "quads/ms"});
+        HZ_INFO("[QuadKernel] {0}: {1} quads/ms", name, quadsPerMs);
+        s_Sink = s_Sink + xs[quadCount * 2] + ys[quadCount * 2];
+    };
+
+    // 原来的路径：translate * rotate * scale，再用mat4乘4个单位顶点
+    const glm::vec4 unitQuad[4] = {
+        {-0.5f, -0.5f, 0.0f, 1.0f}, {0.5f, -0.5f, 0.0f, 1.0f}, {0.5f, 0.5f, 0.0f, 1.0f}, {-0.5f, 0.5f, 0.0f, 1.0f}
+    };
+    addResult("mat4 rotated (before)", MeasureMilliseconds(iterations, [&]() {
+        for (uint32_t i = 0; i < quadCount; i++) {
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), {positions[i].x, positions[i].y, 0.0f})
+                                  * glm::rotate(glm::mat4(1.0f), rotations[i], {0.0f, 0.0f, 1.0f})
+                                  * glm::scale(glm::mat4(1.0f), {sizes[i].x, sizes[i].y, 1.0f});
+            for (int j = 0; j < 4; j++) {
+                glm::vec4 p = transform * unitQuad[j];
+                xs[i * 4 + j] = p.x;
+                ys[i * 4 + j] = p.y;
+            }
+        }
+    }));
+    addResult("mat4 axis-aligned (before)", MeasureMilliseconds(iterations, [&]() {
+        for (uint32_t i = 0; i < quadCount; i++) {
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), {positions[i].x, positions[i].y, 0.0f})
+                                  * glm::scale(glm::mat4(1.0f), {sizes[i].x, sizes[i].y, 1.0f});
+            for (int j = 0; j < 4; j++) {
+                glm::vec4 p = transform * unitQuad[j];
+                xs[i * 4 + j] = p.x;
+                ys[i * 4 + j] = p.y;
+            }
+        }
+    }));
+
+    // QuadKernel在每个CPU支持的SIMD级别上各跑一遍
+    Hazel::SIMD::Level previous = Hazel::QuadKernel::GetLevel();
+    int supported = (int)Hazel::SIMD::GetSupportedLevel();
+    for (int level = 0; level <= supported; level++) {
+        Hazel::QuadKernel::SetLevel((Hazel::SIMD::Level)level);
+        std::string suffix = std::string(" (") + Hazel::SIMD::GetLevelName((Hazel::SIMD::Level)level) + ")";
+
+        addResult("kernel per-quad rotated" + suffix, MeasureMilliseconds(iterations, [&]() {
+            for (uint32_t i = 0; i < quadCount; i++) {
+                Hazel::QuadKernel::GenerateCorners(positions[i], sizes[i], rotations[i], &xs[i * 4], &ys[i * 4]);
+            }
+        }));
+        addResult("kernel per-quad axis-aligned" + suffix, MeasureMilliseconds(iterations, [&]() {
+            for (uint32_t i = 0; i < quadCount; i++) {
+                Hazel::QuadKernel::GenerateCornersAxisAligned(positions[i], sizes[i], &xs[i * 4], &ys[i * 4]);
+            }
+        }));
+        addResult("kernel batch rotated" + suffix, MeasureMilliseconds(iterations, [&]() {
+            Hazel::QuadKernel::GenerateCorners(positions.data(), sizes.data(), rotations.data(), quadCount, xs.data(), ys.data());
+        }));
+        addResult("kernel batch axis-aligned" + suffix, MeasureMilliseconds(iterations, [&]() {
+            Hazel::QuadKernel::GenerateCorners(positions.data(), sizes.data(), nullptr, quadCount, xs.data(), ys.data());
+        }));
+    }
+    Hazel::QuadKernel::SetLevel(previous);
+
+    return results;
+}
+
+std::vector<Benchmark::Result> Benchmark::RunSpatialGrid(uint32_t spriteCount, uint32_t iterations) {
+    HZ_PROFILE_FUNCTION();
+
+    // 密度约为每平方单位一个精灵
+    const float worldHalfSize = std::sqrt((float)spriteCount) * 0.5f;
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> posDist(-worldHalfSize, worldHalfSize);
+    std::uniform_real_distribution<float> sizeDist(0.25f, 1.0f);
+
+    std::vector<glm::vec2> centers(spriteCount), halfExtents(spriteCount);
+    for (uint32_t i = 0; i < spriteCount; i++) {
+        centers[i] = {posDist(rng), posDist(rng)};
+        halfExtents[i] = {sizeDist(rng), sizeDist(rng)};
+    }
+
+    std::vector<Result> results;
+    auto addResult = [&](const std::string& name, float value, const char* unit) {
+        results.push_back({name, value, unit});
+        HZ_INFO("[SpatialGrid] {0}: {1} {2}", name, value, unit);
+    };
+
+    Hazel::SpatialHashGrid grid;
+    addResult("build " + std::to_string(spriteCount) + " sprites", MeasureMilliseconds(1, [&]() {
+        grid.Build(centers.data(), halfExtents.data(), spriteCount);
+    }), "ms");
+
+    Hazel::OrthographicCameraController cameraController(16.0f / 9.0f);
+    std::vector<uint32_t> visible;
+    visible.reserve(spriteCount);
+    for (float zoom : {1.0f, 10.0f, 100.0f, worldHalfSize}) {
+        cameraController.SetZoomLevel(zoom);
+        glm::vec2 min, max;
+        cameraController.GetCamera().GetWorldBounds(min, max);
+        std::string suffix = " (zoom " + std::to_string((int)zoom) + ")";
+
+        float gridMs = MeasureMilliseconds(iterations, [&]() {
+            visible.clear();
+            grid.Query(min, max, visible);
+        });
+        addResult("visible" + suffix, (float)visible.size(), "sprites");
+        addResult("grid query" + suffix, gridMs / iterations, "ms");
+
+        addResult("linear scan" + suffix, MeasureMilliseconds(iterations, [&]() {
+            visible.clear();
+            for (uint32_t i = 0; i < spriteCount; i++) {
+                if (centers[i].x + halfExtents[i].x >= min.x && centers[i].x - halfExtents[i].x <= max.x &&
+                    centers[i].y + halfExtents[i].y >= min.y && centers[i].y - halfExtents[i].y <= max.y) {
+                    visible.push_back(i);
+                }
+            }
+        }) / iterations, "ms");
+    }
+
+    // 增量更新：移动1%的精灵
+    std::uniform_int_distribution<uint32_t> indexDist(0, spriteCount - 1);
+    const uint32_t moveCount = spriteCount / 100;
+    addResult("move " + std::to_string(moveCount) + " sprites", MeasureMilliseconds(1, [&]() {
+        for (uint32_t i = 0; i < moveCount; i++) {
+            uint32_t index = indexDist(rng);
+            centers[index] += glm::vec2(3.0f, -2.0f);
+            grid.Move(index, centers[index], halfExtents[index]);
+        }
+    }), "ms");
+
+    return results;
+}
+
+std::vector<Benchmark::Result> Benchmark::RunParticles(uint32_t particleCount, uint32_t iterations) {
+    HZ_PROFILE_FUNCTION();
+
+    std::vector<Result> results;
+    auto addResult = [&](const std::string& name, float ms) {
+        float nsPerParticle = ms * 1000000.0f / ((float)particleCount * (float)iterations);
+        results.push_back({name, nsPerParticle, "ns/particle"});
+        HZ_INFO("[Particles] {0}: {1} ns/particle", name, nsPerParticle);
+    };
+
+    Hazel::ParticleProps props;
+    props.Velocity = {0.0f, 1.0f};
+    props.VelocityVariation = {3.0f, 1.0f};
+    props.ColorBegin = {1.0f, 0.5f, 0.2f, 1.0f};
+    props.ColorEnd = {0.2f, 0.2f, 0.8f, 0.0f};
+    props.SizeBegin = 0.2f;
+    props.SizeVariation = 0.1f;
+    const float dt = 1.0f / 60.0f;
+
+    Hazel::SIMD::Level previous = Hazel::ParticleSystem::GetLevel();
+    int supported = (int)Hazel::SIMD::GetSupportedLevel();
+    for (int level = 0; level <= supported; level++) {
+        Hazel::ParticleSystem::SetLevel((Hazel::SIMD::Level)level);
+        std::string suffix = std::string(" (") + Hazel::SIMD::GetLevelName((Hazel::SIMD::Level)level) + ")";
+
+        // 寿命足够长，测量期间没有粒子死亡，只有积分和插值
+        Hazel::ParticleSystem system(particleCount);
+        props.LifeTime = 1000.0f;
+        system.Emit(props, particleCount);
+        addResult("update" + suffix, MeasureMilliseconds(iterations, [&]() {
+            system.OnUpdate(dt);
+        }));
+
+        // 寿命约1秒，每帧约1/60的粒子死亡，再发射同样数量补满
+        Hazel::ParticleSystem churn(particleCount);
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> lifeDist(0.5f, 1.5f);
+        for (uint32_t i = 0; i < particleCount; i += 1000) {
+            props.LifeTime = lifeDist(rng);
+            churn.Emit(props, 1000);
+        }
+        addResult("update + emit" + suffix, MeasureMilliseconds(iterations, [&]() {
+            churn.OnUpdate(dt);
+            props.LifeTime = lifeDist(rng);
+            churn.Emit(props, churn.GetCapacity() - churn.GetCount());
+        }));
+        s_Sink = s_Sink + (float)churn.GetCount();
+    }
+    Hazel::ParticleSystem::SetLevel(previous);
+
+    return results;
+}
+
+std::vector<Benchmark::Result> Benchmark::RunLighting(uint32_t iterations) {
+    HZ_PROFILE_FUNCTION();
+
+    std::vector<Result> results;
+    const uint32_t viewportWidth = 1280, viewportHeight = 720;
+    Hazel::OrthographicCameraController cameraController((float)viewportWidth / (float)viewportHeight);
+    cameraController.SetZoomLevel(10.0f);
+    glm::vec2 min, max;
+    cameraController.GetCamera().GetWorldBounds(min, max);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> xDist(min.x, max.x);
+    std::uniform_real_distribution<float> yDist(min.y, max.y);
+    std::uniform_real_distribution<float> radiusDist(0.5f, 2.0f);
+    std::vector<Hazel::PointLight> lights(4096);
+    for (auto& light : lights) {
+        light.Position = {xDist(rng), yDist(rng)};
+        light.Radius = radiusDist(rng);
+    }
+
+    Hazel::LightGrid grid(16);
+    for (uint32_t count = 16; count <= 4096; count *= 4) {
+        const std::string suffix = " (" + std::to_string(count) + " lights)";
+        float ms = MeasureMilliseconds(iterations, [&]() {
+            grid.Bin(cameraController.GetCamera(), viewportWidth, viewportHeight, lights.data(), count);
+        }) / iterations;
+        results.push_back({"bin" + suffix, ms, "ms"});
+        HZ_INFO("[Lighting] bin{0}: {1} ms", suffix, ms);
+
+        const uint32_t tiles = grid.GetTilesX() * grid.GetTilesY();
+        float perTile = (float)grid.GetTileEntryCount() / (float)tiles;
+        results.push_back({"avg per tile" + suffix, perTile, "lights"});
+        results.push_back({"max per tile" + suffix, (float)grid.GetMaxLightsPerTile(), "lights"});
+        HZ_INFO("[Lighting] per tile{0}: avg {1}, max {2}", suffix, perTile, grid.GetMaxLightsPerTile());
+    }
+
+    return results;
+}
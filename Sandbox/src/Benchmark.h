@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Hazel.h"
+
+// CPU端的微基准测试，在Settings面板里手动触发，结果同时打印到日志
+class Benchmark {
+public:
+    struct Result
+    {
+        std::string Name;
+        float Value;
+        const char* Unit;
+    };
+
+    // 对比原来的mat4变换路径与QuadKernel各SIMD级别的顶点生成速度，单位quads/ms
+    static std::vector<Result> RunQuadKernel(uint32_t quadCount = 100000, uint32_t iterations = 20);
+
+    // spriteCount个静态精灵均匀分布在世界里，在OrthographicCameraController的不同缩放级别下
+    // 对比SpatialHashGrid查询和逐个检查包围盒（每帧O(N)的剔除）的耗时，单位ms/query
+    static std::vector<Result> RunSpatialGrid(uint32_t spriteCount = 1000000, uint32_t iterations = 20);
+
+    // ParticleSystem::OnUpdate在各SIMD级别下的耗时，以及每帧有粒子死亡和补充发射时的耗时，单位ns/particle
+    static std::vector<Result> RunParticles(uint32_t particleCount = 100000, uint32_t iterations = 100);
+
+    // 16到4096个随机分布的点光源，1280x720视口、16像素瓦片下LightGrid::Bin的耗时(ms)，
+    // 以及每个瓦片平均要计算的光源数，它决定片元着色器的开销；不分块时每个片元都要计算全部光源
+    static std::vector<Result> RunLighting(uint32_t iterations = 100);
+};
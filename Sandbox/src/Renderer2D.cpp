@@ -1,6 +1,9 @@
 #include "Renderer2D.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <thread>
 
 #include "imgui.h"
 #include <glm/gtc/matrix_transform.hpp>
@@ -53,6 +56,142 @@ void Renderer2D::OnAttach() {
 
     m_CheckerboardTexture = Hazel::Texture2D::Create("../assets/textures/Checkerboard.png");
     m_CoverTexture = Hazel::Texture2D::Create("../assets/textures/Cover.jpeg");
+
+    for(float y = -5.0f; y < 5.0f; y += 0.5f) {
+        for (float x = -5.0f; x < 5.0f; x += 0.5f) {
+            m_GridPositions.push_back({x, y});
+            m_GridSizes.push_back({0.45f, 0.45f});
+            m_GridColors.push_back({(x+5.0f)/10.0f, 0.4f, (y+5.0f)/10.0f, 0.7f});
+        }
+    }
+
+    m_Background = Hazel::Renderer2D::CreateSpriteBuffer(1 + (uint32_t)m_GridPositions.size());
+    Hazel::SpriteBuffer::Sprite checkerboard;
+    checkerboard.Position = {0.0f, 0.0f, -0.1f};
+    checkerboard.Size = {10.0f, 10.0f};
+    checkerboard.Texture = m_CheckerboardTexture;
+    checkerboard.TilingFactor = 10.0f;
+    m_Background->Add(checkerboard);
+    for (size_t i = 0; i < m_GridPositions.size(); i++) {
+        Hazel::SpriteBuffer::Sprite cell;
+        cell.Position = {m_GridPositions[i], 0.0f};
+        cell.Size = m_GridSizes[i];
+        cell.Color = m_GridColors[i];
+        m_GridSprites.push_back(m_Background->Add(cell));
+    }
+
+    // 生成一批不同尺寸的小图放进图集，模拟大量UI图标
+    m_Atlas = Hazel::CreateRef<Hazel::TextureAtlas>();
+    std::vector<uint32_t> pixels;
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t width = 8 + (i * 7) % 41;
+        uint32_t height = 8 + (i * 13) % 37;
+        pixels.assign(width * height, 0);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                bool border = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+                uint8_t r = border ? 255 : (uint8_t)(i * 37);
+                uint8_t g = border ? 255 : (uint8_t)(x * 255 / width);
+                uint8_t b = border ? 255 : (uint8_t)(y * 255 / height);
+                pixels[y * width + x] = r | (g << 8) | (b << 16) | (0xffu << 24);
+            }
+        }
+        m_AtlasSprites.push_back(m_Atlas->Add(pixels.data(), width, height));
+    }
+
+    // 生成一张256x128的精灵表，每帧32x32，帧号越大圆点转得越远，模拟角色动画
+    const uint32_t sheetWidth = 256, sheetHeight = 128, frameSize = 32;
+    pixels.assign(sheetWidth * sheetHeight, 0);
+    for (uint32_t y = 0; y < sheetHeight; y++) {
+        for (uint32_t x = 0; x < sheetWidth; x++) {
+            uint32_t column = x / frameSize, row = y / frameSize;
+            float angle = column / 8.0f * 6.2831853f;
+            float dx = (float)(x % frameSize) - 16.0f - 10.0f * std::cos(angle);
+            float dy = (float)(y % frameSize) - 16.0f - 10.0f * std::sin(angle);
+            bool dot = dx * dx + dy * dy < 16.0f;
+            bool border = x % frameSize == 0 || y % frameSize == 0;
+            uint8_t shade = (uint8_t)(64 + row * 48);
+            pixels[y * sheetWidth + x] = dot ? 0xffffffffu : border ? (0xffu << 24) : shade | ((uint8_t)(255 - shade) << 8) | (0x80u << 16) | (0xffu << 24);
+        }
+    }
+    m_SpriteSheet = Hazel::Texture2D::Create(sheetWidth, sheetHeight);
+    m_SpriteSheet->SetData(pixels.data(), sheetWidth * sheetHeight * 4);
+    for (uint32_t row = 0; row < 4; row++) {
+        for (uint32_t column = 0; column < 8; column++) {
+            m_SheetFrames.push_back(Hazel::SubTexture2D::CreateFromCoords(m_SpriteSheet, {(float)column, (float)row}, {(float)frameSize, (float)frameSize}));
+        }
+    }
+
+    // 8x8格、每格16像素的图块集，再用它铺一张4096x4096的地图
+    const uint32_t tileSize = 16, tilesetSize = tileSize * 8;
+    pixels.assign(tilesetSize * tilesetSize, 0);
+    for (uint32_t y = 0; y < tilesetSize; y++) {
+        for (uint32_t x = 0; x < tilesetSize; x++) {
+            uint32_t cell = (y / tileSize) * 8 + x / tileSize;
+            bool border = x % tileSize == 0 || y % tileSize == 0;
+            uint8_t r = (uint8_t)(40 + (cell % 8) * 20), g = (uint8_t)(60 + (cell / 8) * 20), b = (uint8_t)(cell * 4);
+            pixels[y * tilesetSize + x] = border ? (0xffu << 24) | 0x202020u : r | (g << 8) | (b << 16) | (0xffu << 24);
+        }
+    }
+    Hazel::Ref<Hazel::Texture2D> tileset = Hazel::Texture2D::Create(tilesetSize, tilesetSize);
+    tileset->SetData(pixels.data(), tilesetSize * tilesetSize * 4);
+
+    const uint32_t worldSize = 4096;
+    m_Tilemap = Hazel::CreateRef<Hazel::Tilemap>(worldSize, worldSize, tileset, 8, 8);
+    m_Tilemap->SetPosition({-(float)worldSize * 0.5f, -(float)worldSize * 0.5f, -0.5f});
+    m_Tilemap->SetTileSize(1.0f);
+    std::vector<uint16_t> row(worldSize);
+    for (uint32_t y = 0; y < worldSize; y++) {
+        for (uint32_t x = 0; x < worldSize; x++) {
+            // 简单的哈希噪声，约1/8的瓦片留空
+            uint32_t hash = (x * 73856093u) ^ (y * 19349663u);
+            row[x] = (hash >> 7) % 8 == 0 ? 0 : (uint16_t)(1 + ((x / 16 + y / 16) % 8) * 8 + (hash >> 3) % 8);
+        }
+        m_Tilemap->SetTiles(0, y, worldSize, 1, row.data());
+    }
+
+    // 512x512个小精灵铺满瓦片世界中间的一块，只在GPU上剔除，CPU每帧不遍历它们
+    const uint32_t fieldSize = 512;
+    m_Field = Hazel::Renderer2D::CreateSpriteBuffer(fieldSize * fieldSize, true);
+    for (uint32_t y = 0; y < fieldSize; y++) {
+        for (uint32_t x = 0; x < fieldSize; x++) {
+            uint32_t hash = (x * 2654435761u) ^ (y * 40503u);
+            Hazel::SpriteBuffer::Sprite sprite;
+            sprite.Position = {((float)x - fieldSize * 0.5f) * 2.0f, ((float)y - fieldSize * 0.5f) * 2.0f, -0.3f};
+            sprite.Size = {0.6f + (hash % 7) * 0.1f, 0.6f + (hash >> 3) % 7 * 0.1f};
+            sprite.Rotation = (float)(hash % 90);
+            sprite.Color = {(hash & 0xff) / 255.0f, ((hash >> 8) & 0xff) / 255.0f, ((hash >> 16) & 0xff) / 255.0f, 1.0f};
+            m_Field->Add(sprite);
+        }
+    }
+
+    // 使用ImGui自带的字体
+    m_Font = Hazel::CreateRef<Hazel::Font>("../Hazel/vendor/imgui/misc/fonts/Roboto-Medium.ttf");
+
+    // 64张64x64的图块放进同一个纹理数组
+    m_TexturePool = Hazel::CreateRef<Hazel::TextureArrayPool>();
+    pixels.resize(64 * 64);
+    for (uint32_t i = 0; i < 64; i++) {
+        for (uint32_t y = 0; y < 64; y++) {
+            for (uint32_t x = 0; x < 64; x++) {
+                bool checker = ((x / (4 + i % 8)) + (y / (4 + i / 8))) % 2 == 0;
+                uint8_t shade = checker ? 255 : 96;
+                pixels[y * 64 + x] = (uint8_t)(shade * (i % 4) / 3) | (shade << 8) | ((uint8_t)(shade * (i / 16) / 3) << 16) | (0xffu << 24);
+            }
+        }
+        m_ArrayTiles.push_back(m_TexturePool->Add(pixels.data(), 64, 64));
+    }
+
+    m_Particles = Hazel::CreateRef<Hazel::ParticleSystem>(100000);
+    m_LightGrid = Hazel::CreateRef<Hazel::LightGrid>(16);
+
+    // 起伏的地形：上边是256段的曲线，下边是平的底，整体是一个凹多边形
+    for (uint32_t i = 0; i <= 256; i++) {
+        float x = -25.0f + i * 0.1f;
+        m_TerrainOutline.push_back({x, -18.0f + 1.5f * std::sin(x * 0.7f) + 0.5f * std::sin(x * 2.3f)});
+    }
+    m_TerrainOutline.push_back({0.6f, -24.0f});
+    m_TerrainOutline.push_back({-25.0f, -24.0f});
 }
 
 void Renderer2D::OnDetach() {
@@ -65,6 +204,7 @@ void Renderer2D::OnUpdate(Hazel::Timestep ts) {
 	m_CameraController.OnUpdate(ts);
 
     Hazel::Renderer2D::ResetStats();
+    m_Atlas->Update();
     
 	{
 		HZ_PROFILE_SCOPE("Renderer Prep");
@@ -79,6 +219,51 @@ void Renderer2D::OnUpdate(Hazel::Timestep ts) {
         static float rotation = 0.f;
         rotation += ts * 50.0f;
 
+        Hazel::Renderer2D::SetQuadRenderMode((Hazel::Renderer2D::QuadRenderMode)m_QuadRenderMode);
+        Hazel::Renderer2D::SetStreamingUpload(m_StreamingUpload);
+        Hazel::Renderer2D::SetPackedVertices(m_PackedVertices);
+        Hazel::Renderer2D::SetSortedSubmission(m_SortedSubmission);
+        Hazel::Renderer2D::SetCulling(m_Culling);
+        Hazel::Renderer2D::SetOcclusionCulling(m_OcclusionCulling);
+
+        if (m_Lighting) {
+            // 光源在几个同心圆上以不同的速度公转，颜色按黄金角分布
+            m_LightTime += ts;
+            m_Lights.resize(m_LightCount);
+            for (int i = 0; i < m_LightCount; i++) {
+                float orbit = 1.0f + (i % 16) * 1.5f;
+                float angle = m_LightTime * (0.3f + (i % 5) * 0.1f) + i * 2.39996f;
+                Hazel::PointLight& light = m_Lights[i];
+                light.Position = {orbit * std::cos(angle), orbit * std::sin(angle)};
+                light.Radius = 1.0f + (i % 3) * 0.75f;
+                light.Color = {0.5f + 0.5f * std::cos(i * 2.39996f), 0.5f + 0.5f * std::cos(i * 2.39996f + 2.1f),
+                               0.5f + 0.5f * std::cos(i * 2.39996f + 4.2f)};
+                light.Intensity = 1.5f;
+            }
+            auto& window = Hazel::Application::Get().GetWindow();
+            m_LightGrid->Build(m_CameraController.GetCamera(), window.GetWidth(), window.GetHeight(), m_Lights.data(), (uint32_t)m_Lights.size());
+            Hazel::Renderer2D::SetLightGrid(m_LightGrid);
+        } else {
+            Hazel::Renderer2D::SetLightGrid(nullptr);
+        }
+
+        if (m_ShowTilemap) {
+            // 原点附近的一行瓦片依次改写，每帧只有一个块上传一行
+            const uint32_t center = m_Tilemap->GetWidth() / 2;
+            m_Tilemap->SetTile(center - 32 + m_TilemapCursor % 64, center + 6, (uint16_t)(1 + m_TilemapCursor % 64));
+            m_TilemapCursor++;
+
+            Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
+            Hazel::Renderer2D::DrawTilemap(m_Tilemap);
+            Hazel::Renderer2D::EndScene();
+        }
+
+        if (m_ShowField) {
+            Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
+            Hazel::Renderer2D::DrawSpriteBuffer(m_Field);
+            Hazel::Renderer2D::EndScene();
+        }
+
         Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
         // 旋转45°
         Hazel::Renderer2D::DrawQuad({1.0f, 0.0f}, {0.8f, 0.8f}, -45, {0.8f, 0.2f, 0.3f, 1.0f});
@@ -86,20 +271,211 @@ void Renderer2D::OnUpdate(Hazel::Timestep ts) {
         // 静态矩形
         Hazel::Renderer2D::DrawQuad({-1.0f, 0.0f}, {0.8f, 0.8f}, {0.8f, 0.2f, 0.3f, 1.0f});
         Hazel::Renderer2D::DrawQuad({0.5f, -0.5f}, {0.5f, 0.75f}, {0.2f, 0.3f, 0.8f, 1.0f});
-        Hazel::Renderer2D::DrawQuad({0.0f, 0.0f, -0.1f}, {10.0f, 10.0f}, m_CheckerboardTexture, 10.0f);
+        if (!m_RetainedBackground) {
+            Hazel::Renderer2D::DrawQuad({0.0f, 0.0f, -0.1f}, {10.0f, 10.0f}, m_CheckerboardTexture, 10.0f);
+        }
 
         // 持续旋转45°
         Hazel::Renderer2D::DrawQuad({1.f, 0.5f, 0.1f}, {0.8f, 0.8f}, rotation, m_CoverTexture, 1.0f);
+
+        if (m_RetainedBackground) {
+            // 高亮的格子每帧移动一格，只有这两个格子需要重新上传
+            auto setCell = [&](uint32_t index, const glm::vec4& color) {
+                Hazel::SpriteBuffer::Sprite cell;
+                cell.Position = {m_GridPositions[index], 0.0f};
+                cell.Size = m_GridSizes[index];
+                cell.Color = color;
+                m_Background->Set(m_GridSprites[index], cell);
+            };
+            setCell(m_HighlightCell, m_GridColors[m_HighlightCell]);
+            m_HighlightCell = (m_HighlightCell + 1) % m_GridSprites.size();
+            setCell(m_HighlightCell, {1.0f, 1.0f, 1.0f, 0.9f});
+
+            Hazel::Renderer2D::DrawSpriteBuffer(m_Background);
+        }
         Hazel::Renderer2D::EndScene();
 
+        if (!m_RetainedBackground) {
+            Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
+            Hazel::Renderer2D::QuadBatch grid;
+            grid.Count = (uint32_t)m_GridPositions.size();
+            grid.Positions = m_GridPositions.data();
+            grid.Sizes = m_GridSizes.data();
+            grid.Colors = m_GridColors.data();
+            Hazel::Renderer2D::DrawQuads(grid);
+            Hazel::Renderer2D::EndScene();
+        }
+
+        if (m_ShowArrayTiles) {
+            // 1024个图块来自64个不同的纹理，但都在同一个纹理数组里，一次draw call
+            Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
+            for (uint32_t y = 0; y < 32; y++) {
+                for (uint32_t x = 0; x < 32; x++) {
+                    const Hazel::TextureLayer& tile = m_ArrayTiles[(x * 7 + y * 3) % m_ArrayTiles.size()];
+                    Hazel::Renderer2D::DrawQuad({6.0f + x * 0.25f, -4.0f + y * 0.25f, 0.1f}, {0.25f, 0.25f}, tile);
+                }
+            }
+            Hazel::Renderer2D::EndScene();
+        }
+
+        if (m_ThreadedSubmission) {
+            // 100x100个旋转的小矩形分给多个线程生成顶点，EndScene按线程下标合并
+            Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
+            const uint32_t threadCount = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+            const uint32_t rows = 100;
+            std::vector<std::thread> workers;
+            for (uint32_t t = 0; t < threadCount; t++) {
+                workers.emplace_back([=]() {
+                    Hazel::Renderer2D::BeginThreadSubmission(t);
+                    for (uint32_t y = t * rows / threadCount; y < (t + 1) * rows / threadCount; y++) {
+                        for (uint32_t x = 0; x < 100; x++) {
+                            glm::vec3 position = {-15.0f + x * 0.1f, 6.0f + y * 0.1f, 0.1f};
+                            glm::vec4 color = {x / 100.0f, y / 100.0f, 0.6f, 1.0f};
+                            Hazel::Renderer2D::DrawQuad(position, {0.08f, 0.08f}, rotation + x + y, color);
+                        }
+                    }
+                    Hazel::Renderer2D::EndThreadSubmission();
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            Hazel::Renderer2D::EndScene();
+        }
+
+        // 纹理槽纹理和纹理数组交替提交，立即提交时每个矩形都要切换一次批次，排序提交后只剩两个批次
         Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
-        for(float y = -5.0f; y < 5.0f; y += 0.5f) {
-            for (float x = -5.0f; x < 5.0f; x += 0.5f) {
-                glm::vec4 color = {(x+5.0f)/10.0f, 0.4f, (y+5.0f)/10.0f, 0.7f};
-                Hazel::Renderer2D::DrawQuad({x, y}, {0.45f, 0.45f}, color);
+        for (uint32_t i = 0; i < 64; i++) {
+            glm::vec3 position = {-4.0f + i * 0.25f, -5.0f, 0.1f};
+            if (i % 2) {
+                Hazel::Renderer2D::DrawQuad(position, {0.2f, 0.2f}, m_CheckerboardTexture);
+            } else {
+                Hazel::Renderer2D::DrawQuad(position, {0.2f, 0.2f}, m_ArrayTiles[i % m_ArrayTiles.size()]);
             }
         }
         Hazel::Renderer2D::EndScene();
+
+        if (m_ShowSpriteSheet) {
+            // 200个角色各自播放精灵表的一行，所有帧都在同一张纹理上，一个批次画完
+            m_AnimationTime += ts;
+            uint32_t frame = (uint32_t)(m_AnimationTime * 12.0f);
+            Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
+            for (uint32_t i = 0; i < 200; i++) {
+                uint32_t row = i % 4;
+                glm::vec3 position = {-5.0f + (i % 20) * 0.5f, 5.5f + (i / 20) * 0.5f, 0.2f};
+                Hazel::Renderer2D::DrawQuad(position, {0.45f, 0.45f}, m_SheetFrames[row * 8 + (frame + i) % 8]);
+            }
+            Hazel::Renderer2D::EndScene();
+        }
+
+        if (m_ShowText && m_Font->IsLoaded()) {
+            // 2000个向上飘的伤害数字，所有字形都在字体的图集上，和精灵一样批量绘制
+            m_TextTime += ts;
+            Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
+            Hazel::Renderer2D::DrawString("Hazel SDF Text", m_Font, glm::vec3(-5.0f, 11.5f, 0.3f), 1.0f, {1.0f, 0.9f, 0.5f, 1.0f});
+            for (uint32_t i = 0; i < 2000; i++) {
+                float life = std::fmod(m_TextTime + i * 0.37f, 2.0f);
+                glm::vec3 position = {-10.0f + (i * 7919 % 2000) * 0.01f, -10.0f + (i * 104729 % 2000) * 0.01f + life, 0.3f};
+                glm::vec4 color = {1.0f, 0.3f + (i % 7) * 0.1f, 0.2f, 1.0f - life * 0.5f};
+                Hazel::Renderer2D::DrawString(std::to_string(i * 37 % 1000), m_Font, position, 0.3f, color);
+            }
+            Hazel::Renderer2D::EndScene();
+        }
+
+        if (m_ShowParticles) {
+            m_EmitterTime += ts;
+            Hazel::ParticleProps props;
+            props.Position = {std::cos(m_EmitterTime) * 6.0f, std::sin(m_EmitterTime) * 6.0f};
+            props.Velocity = {0.0f, 1.5f};
+            props.VelocityVariation = {4.0f, 2.0f};
+            props.ColorBegin = {1.0f, 0.6f, 0.2f, 1.0f};
+            props.ColorEnd = {0.6f, 0.1f, 0.8f, 0.0f};
+            props.SizeBegin = 0.15f;
+            props.SizeVariation = 0.1f;
+            props.LifeTime = 1.5f;
+            m_Particles->Emit(props, 2000);
+            m_Particles->OnUpdate(ts);
+
+            Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
+            m_Particles->OnRender(0.4f);
+            Hazel::Renderer2D::EndScene();
+        } else {
+            m_Particles->Clear();
+        }
+
+        if (m_ShowShapes) {
+            // 调试视图：1万个碰撞体的描边和连线，圆、线段和圆角矩形都是带形状编码的纯色矩形，和普通矩形一起合批
+            Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
+            for (uint32_t y = 0; y < 100; y++) {
+                for (uint32_t x = 0; x < 100; x++) {
+                    glm::vec3 center = {-25.0f + x * 0.2f, -25.0f + y * 0.2f, 0.5f};
+                    glm::vec4 color = {0.2f + x * 0.008f, 1.0f, 0.2f + y * 0.008f, 0.8f};
+                    if ((x + y) % 2) {
+                        Hazel::Renderer2D::DrawCircle(center, 0.08f, color, 0.015f);
+                    } else {
+                        Hazel::Renderer2D::DrawRoundedRect(center, {0.16f, 0.12f}, rotation + x, 0.03f, color, 0.015f);
+                    }
+                }
+            }
+            for (uint32_t i = 0; i < 3; i++) {
+                glm::vec2 p0 = {-25.0f, -5.5f - i * 0.5f};
+                glm::vec2 p1 = {-5.5f, -5.5f - i * 0.5f};
+                Hazel::Renderer2D::DrawLine(p0, p1, 0.2f, {1.0f, 0.8f, 0.2f, 1.0f}, (Hazel::Renderer2D::LineCap)i);
+            }
+            Hazel::Renderer2D::DrawCircle(glm::vec3(-3.0f, -7.0f, 0.5f), 1.0f, {0.9f, 0.3f, 0.3f, 1.0f});
+            Hazel::Renderer2D::DrawRoundedRect(glm::vec3(0.0f, -7.0f, 0.5f), {3.0f, 1.5f}, 0.0f, 0.4f, {0.3f, 0.3f, 0.9f, 0.9f});
+            Hazel::Renderer2D::EndScene();
+        }
+
+        if (m_ShowLayers) {
+            // 层叠场景：后面是1万个小瓦片，前面三块不透明的面板挡住了它们中的大部分
+            // 面板先作为遮挡物写入遮挡缓冲，被完全盖住的瓦片不生成顶点
+            Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
+            for (uint32_t i = 0; i < 3; i++) {
+                const glm::vec3 panel = {12.0f + i * 8.0f, 20.0f, 0.25f};
+                Hazel::Renderer2D::AddOccluder(panel, {7.5f, 10.0f});
+                Hazel::Renderer2D::DrawQuad(panel, {7.5f, 10.0f}, {0.15f, 0.15f, 0.2f, 1.0f});
+            }
+            for (uint32_t y = 0; y < 100; y++) {
+                for (uint32_t x = 0; x < 100; x++) {
+                    glm::vec3 position = {8.0f + x * 0.24f, 15.0f + y * 0.1f, 0.05f};
+                    Hazel::Renderer2D::DrawQuad(position, {0.2f, 0.08f}, {x / 100.0f, 0.4f, y / 100.0f, 1.0f});
+                }
+            }
+            Hazel::Renderer2D::EndScene();
+        }
+
+        if (m_ShowPolygons) {
+            // 多边形的顶点和矩形在同一个顶点流里，批次里有多边形时换用动态索引
+            Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
+            Hazel::Renderer2D::DrawPolygon(m_TerrainOutline.data(), (uint32_t)m_TerrainOutline.size(), 0.3f, m_CheckerboardTexture, 20.0f,
+                                           {0.6f, 0.8f, 0.5f, 1.0f});
+            for (uint32_t i = 0; i < 400; i++) {
+                glm::vec2 center = {-24.0f + (i % 40) * 0.6f, -14.0f + (i / 40) * 0.6f};
+                glm::vec2 star[10];
+                for (uint32_t j = 0; j < 10; j++) {
+                    float angle = glm::radians(rotation + i + j * 36.0f);
+                    float radius = j % 2 ? 0.12f : 0.28f;
+                    star[j] = {center.x + radius * std::cos(angle), center.y + radius * std::sin(angle)};
+                }
+                Hazel::Renderer2D::DrawPolygon(star, 10, 0.3f, {1.0f, 0.85f, 0.2f + (i % 10) * 0.08f, 1.0f});
+                Hazel::Renderer2D::DrawQuad(glm::vec3(center.x, center.y, 0.29f), {0.1f, 0.1f}, {0.2f, 0.2f, 0.2f, 1.0f});
+            }
+            Hazel::Renderer2D::EndScene();
+        }
+
+        if (m_ShowAtlasSprites) {
+            // 256张图片都在同一页上，只占用一个纹理槽
+            Hazel::Renderer2D::BeginScene(m_CameraController.GetCamera());
+            for (uint32_t i = 0; i < m_AtlasSprites.size(); i++) {
+                const Hazel::TextureAtlas::Region* region = m_Atlas->Get(m_AtlasSprites[i]);
+                if (region) {
+                    glm::vec3 position = {-4.0f + (i % 16) * 0.5f, -4.0f + (i / 16) * 0.5f, 0.2f};
+                    Hazel::Renderer2D::DrawQuad(position, {0.4f, 0.4f}, *region);
+                }
+            }
+            Hazel::Renderer2D::EndScene();
+        }
 	}
 }
 
@@ -112,10 +488,96 @@ void Renderer2D::OnImGuiRender() {
     ImGui::Text("Renderer2D Stats:");
     ImGui::Text("Draw Calls : %d", stats.DrawCalls);
     ImGui::Text("Quads : %d", stats.QuadCount);
+    ImGui::Text("Culled Quads : %d", stats.CulledQuads);
+    ImGui::Text("Occluded Quads : %d", stats.OccludedQuads);
+    ImGui::Text("Text Glyphs : %d", stats.TextGlyphs);
+    ImGui::Text("Shapes : %d", stats.Shapes);
+    ImGui::Text("Polygons : %d (%d triangles)", stats.Polygons, stats.PolygonTriangles);
+    if (m_ShowTilemap) {
+        ImGui::Text("Tilemap : %d chunks, %d bytes uploaded", stats.TilemapChunks, stats.TilemapUploadBytes);
+    }
+    if (m_ShowParticles) {
+        ImGui::Text("Particles : %d / %d", m_Particles->GetCount(), m_Particles->GetCapacity());
+    }
+    if (m_Lighting) {
+        ImGui::Text("Lights : %d visible, %d tiles, %d entries, max %d per tile", m_LightGrid->GetLightCount(),
+                    m_LightGrid->GetTilesX() * m_LightGrid->GetTilesY(), m_LightGrid->GetTileEntryCount(), m_LightGrid->GetMaxLightsPerTile());
+    }
     ImGui::Text("Vertices : %d", stats.GetTotalVertexCount());
     ImGui::Text("Indices : %d", stats.GetTotalIndexCount());
+    ImGui::Text("Flushes (full/slots/array/explicit) : %d / %d / %d / %d", stats.BatchFullFlushes, stats.TextureSlotFlushes,
+                stats.TextureArrayFlushes, stats.ExplicitFlushes);
+    if (Hazel::Renderer2D::IsStreamingUpload()) {
+        ImGui::Text("Stream Mapping : %s", Hazel::Renderer2D::IsStreamingPersistent() ? "persistent" : "unsynchronized");
+        ImGui::Text("Stream Fence Waits : %d (%.3f ms)", stats.StreamFenceWaits, stats.StreamStallTime);
+        ImGui::Text("Stream Orphans : %d", stats.StreamOrphans);
+    }
+    if (m_RetainedBackground || m_ShowField) {
+        ImGui::Text("Retained : %d quads, %d bytes uploaded", stats.RetainedQuads, stats.RetainedUploadBytes);
+    }
+    if (m_ShowField) {
+        ImGui::Text("GPU Culled Quads : %d / %d", stats.GPUCulledQuads, m_Field->GetCount());
+    }
+    if (m_ThreadedSubmission) {
+        ImGui::Text("Thread Quads : %d", stats.ThreadQuads);
+    }
+    if (Hazel::Renderer2D::IsSortedSubmission()) {
+        ImGui::Text("Sorted Quads : %d, state changes %d -> %d (saved %d)", stats.SortedQuads, stats.UnsortedStateChanges,
+                    stats.SortedStateChanges, stats.GetSavedStateChanges());
+        ImGui::Text("Opaque / Translucent : %d / %d", stats.OpaqueQuads, stats.TranslucentQuads);
+    }
 
     ImGui::ColorEdit4("Square Color", glm::value_ptr(m_SquareColor));
+    // 顺序和Renderer2D::QuadRenderMode一致
+    ImGui::Combo("Quad Render Mode", &m_QuadRenderMode, "Batched\0Instanced\0Vertex Pulling\0");
+    ImGui::Checkbox("Streaming Upload", &m_StreamingUpload);
+    ImGui::Checkbox("Packed Vertices", &m_PackedVertices);
+    ImGui::Checkbox("Sorted Submission", &m_SortedSubmission);
+    ImGui::Checkbox("Threaded Submission", &m_ThreadedSubmission);
+    ImGui::Checkbox("Retained Background", &m_RetainedBackground);
+    ImGui::Checkbox("Frustum Culling", &m_Culling);
+    ImGui::Checkbox("Occlusion Culling", &m_OcclusionCulling);
+    ImGui::Checkbox("Atlas Sprites", &m_ShowAtlasSprites);
+    ImGui::Checkbox("Array Tiles", &m_ShowArrayTiles);
+    ImGui::Checkbox("Sprite Sheet", &m_ShowSpriteSheet);
+    ImGui::Checkbox("Text", &m_ShowText);
+    ImGui::Checkbox("Tilemap", &m_ShowTilemap);
+    ImGui::Checkbox("Particles", &m_ShowParticles);
+    ImGui::Checkbox("Shapes", &m_ShowShapes);
+    ImGui::Checkbox("Polygons", &m_ShowPolygons);
+    ImGui::Checkbox("Layers", &m_ShowLayers);
+    ImGui::Checkbox("GPU Culled Field", &m_ShowField);
+    ImGui::Checkbox("Lighting", &m_Lighting);
+    ImGui::SliderInt("Lights", &m_LightCount, 16, 4096);
+    ImGui::Text("Atlas : %d pages, %d/%d resident, %d evictions", m_Atlas->GetPageCount(),
+                m_Atlas->GetResidentCount(), m_Atlas->GetImageCount(), m_Atlas->GetEvictionCount());
+
+    auto& caps = Hazel::RenderCaps::Get();
+    ImGui::Separator();
+    ImGui::Text("GL %d.%d : %s", caps.VersionMajor, caps.VersionMinor, caps.Renderer.c_str());
+    ImGui::Text("Texture Units : %d, Max Texture Size : %d", caps.MaxTextureSlots, caps.MaxTextureSize);
+    ImGui::Text("Buffer Storage : %s, MDI : %s, Parallel Compile : %s", caps.BufferStorage ? "yes" : "no",
+                caps.MultiDrawIndirect ? "yes" : "no", caps.ParallelShaderCompile ? "yes" : "no");
+
+    ImGui::Separator();
+    if (ImGui::Button("Benchmark QuadKernel")) {
+        m_BenchmarkResults = Benchmark::RunQuadKernel();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark SpatialGrid")) {
+        m_BenchmarkResults = Benchmark::RunSpatialGrid();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark Particles")) {
+        m_BenchmarkResults = Benchmark::RunParticles();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark Lighting")) {
+        m_BenchmarkResults = Benchmark::RunLighting();
+    }
+    for (auto& result : m_BenchmarkResults) {
+        ImGui::Text("%s : %.2f %s", result.Name.c_str(), result.Value, result.Unit);
+    }
 
     ImGui::End();
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Hazel.h"
+#include "Benchmark.h"
 
 class Renderer2D : public Hazel::Layer {
 public:
@@ -33,7 +34,72 @@ private:
     Hazel::Ref<Hazel::Texture2D> m_CheckerboardTexture;
     Hazel::Ref<Hazel::Texture2D> m_CoverTexture;
     std::vector<ProfileResult> m_ProfileResults;
+    std::vector<Benchmark::Result> m_BenchmarkResults;
+
+    // 背景网格的SoA数据，用DrawQuads一次提交
+    std::vector<glm::vec2> m_GridPositions;
+    std::vector<glm::vec2> m_GridSizes;
+    std::vector<glm::vec4> m_GridColors;
+
+    // 棋盘背景和网格常驻在GPU上，每帧只更新高亮的格子
+    Hazel::Ref<Hazel::SpriteBuffer> m_Background;
+    std::vector<Hazel::SpriteBuffer::Handle> m_GridSprites;
+    uint32_t m_HighlightCell = 0;
+
+    Hazel::Ref<Hazel::TextureAtlas> m_Atlas;
+    std::vector<Hazel::TextureAtlas::Handle> m_AtlasSprites;
+
+    // 8x4格的精灵表，每一行是一个动画
+    Hazel::Ref<Hazel::Texture2D> m_SpriteSheet;
+    std::vector<Hazel::Ref<Hazel::SubTexture2D>> m_SheetFrames;
+    float m_AnimationTime = 0.0f;
+
+    // 距离场字体，模拟大量伤害数字
+    Hazel::Ref<Hazel::Font> m_Font;
+    float m_TextTime = 0.0f;
+
+    // 4096x4096的瓦片世界，每帧修改一个瓦片
+    Hazel::Ref<Hazel::Tilemap> m_Tilemap;
+    uint32_t m_TilemapCursor = 0;
+
+    // 沿圆周移动的发射器，每帧发射2000个粒子
+    Hazel::Ref<Hazel::ParticleSystem> m_Particles;
+    float m_EmitterTime = 0.0f;
+
+    // 分块光照：几百个绕原点公转的点光源，每帧按相机重新分块
+    Hazel::Ref<Hazel::LightGrid> m_LightGrid;
+    std::vector<Hazel::PointLight> m_Lights;
+    int m_LightCount = 512;
+    float m_LightTime = 0.0f;
+
+    // 几十万个常驻精灵，GPU剔除之后按实例绘制
+    Hazel::Ref<Hazel::SpriteBuffer> m_Field;
+
+    // 凹的地形轮廓，每帧三角化后和矩形在同一个批次里绘制
+    std::vector<glm::vec2> m_TerrainOutline;
+
+    Hazel::Ref<Hazel::TextureArrayPool> m_TexturePool;
+    std::vector<Hazel::TextureLayer> m_ArrayTiles;
 
     glm::vec4 m_SquareColor = {0.2f, 0.3f, 0.8f, 1.0f};
+    int m_QuadRenderMode = 0;
+    bool m_StreamingUpload = false;
+    bool m_PackedVertices = false;
+    bool m_SortedSubmission = false;
+    bool m_ThreadedSubmission = false;
+    bool m_RetainedBackground = true;
+    bool m_Culling = true;
+    bool m_ShowAtlasSprites = true;
+    bool m_ShowArrayTiles = true;
+    bool m_ShowSpriteSheet = true;
+    bool m_ShowText = true;
+    bool m_ShowTilemap = true;
+    bool m_ShowParticles = true;
+    bool m_ShowShapes = true;
+    bool m_ShowPolygons = true;
+    bool m_Lighting = false;
+    bool m_ShowLayers = true;
+    bool m_OcclusionCulling = true;
+    bool m_ShowField = false;
    
 };
\ No newline at end of file